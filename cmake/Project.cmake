@@ -14,6 +14,8 @@ endmacro(init_project)
 
 option(UNIT_TESTING "Enable Unit Testing" ON)
 option(ENABLE_TSAN "Enable Thread Sanitizer" ON)
+option(ENABLE_ASAN "Enable Address and UndefinedBehavior Sanitizer" OFF)
+option(ENABLE_NUMA "Use libnuma for NUMA aware allocation when available" ON)
 
 macro(set_library_type lib)
 	set(build_shared_var ${lib}_BUILD_SHARED)
@@ -0,0 +1,55 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "container/async_queue.h"
+
+constexpr int Consumers = 100000;
+constexpr int Producers = 2;
+constexpr unsigned ExecutorThreads = 4;
+
+std::atomic<int> totalConsumed{0};
+
+/*!
+ * One logical consumer: waits for a value without polling and without
+ * holding an OS thread while it waits.
+ */
+DetachedTask consumer(AsyncQueue<int, ThreadPoolExecutor>& queue) {
+    co_await queue.pop();
+    totalConsumed.fetch_add(1, std::memory_order_relaxed);
+}
+
+int main() {
+    auto start = std::chrono::high_resolution_clock::now();
+    {
+        ThreadPoolExecutor executor(ExecutorThreads);
+        AsyncQueue<int, ThreadPoolExecutor> queue(executor);
+
+        for (int i = 0; i < Consumers; ++i) {
+            spawn(executor, consumer(queue));
+        }
+
+        std::vector<std::thread> producers;
+        for (int i = 0; i < Producers; ++i) {
+            producers.emplace_back([&, i] {
+                for (int j = i; j < Consumers; j += Producers) {
+                    queue.push(j);
+                }
+            });
+        }
+        for (auto& producer : producers) producer.join();
+
+        while (totalConsumed.load(std::memory_order_relaxed) < Consumers) {
+            std::this_thread::yield();
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+
+    std::cout << "Consumers: " << Consumers << " on " << ExecutorThreads << " threads\n";
+    std::cout << "Total consumed: " << totalConsumed.load() << "\n";
+    std::cout << "Execution Time: " << elapsed.count() << " seconds" << std::endl;
+    return 0;
+}
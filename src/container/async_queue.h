@@ -0,0 +1,174 @@
+#pragma once
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "coroutine_executor.h"
+#include "lock_free_queue.h"
+#include "lock_free_queue_hazard.h"
+#include "spsc_queue.h"
+
+/*!
+ * Awaitable front-ends for the lock-free queues.
+ *
+ * `co_await queue.pop()` completes immediately when a value is available and
+ * otherwise suspends the coroutine until a push() hands it one; the coroutine
+ * is then resumed on the queue's executor. Nobody polls and no OS thread
+ * blocks, so a handful of executor threads can serve any number of waiting
+ * consumers.
+ *
+ * Both sides follow the same handshake: the consumer publishes itself as a
+ * waiter, then re-checks the queue; the producer publishes its value, then
+ * checks for waiters. In between, each side does an acq_rel read-modify-write
+ * on the same word. Those are totally ordered, so whichever side comes second
+ * sees what the first one published and no wakeup is lost. (A seq_cst fence
+ * would do as well, but ThreadSanitizer does not model fences.)
+ */
+
+/*!
+ * Single consumer coroutine over SPSCQueue. The waiter list is one slot.
+ */
+template <typename T, size_t Capacity, Executor E>
+class AsyncSPSCQueue {
+public:
+    explicit AsyncSPSCQueue(E& executor) : executor_(executor), waiter_(nullptr) {}
+
+    /*!
+     * Producer side; false if the ring is full, like SPSCQueue::push.
+     */
+    bool push(T const& value) {
+        if (!queue_.push(value)) return false;
+        if (void* waiter = waiter_.exchange(nullptr, std::memory_order_acq_rel)) {
+            executor_.schedule(std::coroutine_handle<>::from_address(waiter));
+        }
+        return true;
+    }
+
+    class PopAwaiter {
+    public:
+        explicit PopAwaiter(AsyncSPSCQueue& queue) : queue_(queue) {}
+
+        bool await_ready() {
+            ready_ = queue_.queue_.pop(value_);
+            return ready_;
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            AsyncSPSCQueue& queue = queue_;
+            queue.waiter_.exchange(handle.address(), std::memory_order_acq_rel);
+
+            // From here on a producer may resume us at any time: only touch
+            // the queue, not this awaiter.
+            if (queue.queue_.empty()) return true;
+
+            // A value arrived meanwhile. If the slot still holds our handle,
+            // take it back and continue; otherwise the producer resumes us.
+            return nullptr == queue.waiter_.exchange(nullptr, std::memory_order_acq_rel);
+        }
+
+        T await_resume() {
+            if (!ready_) queue_.queue_.pop(value_);
+            return std::move(value_);
+        }
+
+    private:
+        AsyncSPSCQueue& queue_;
+        T value_{};
+        bool ready_ = false;
+    };
+
+    /*!
+     * Consumer side, only one coroutine may await at a time.
+     */
+    PopAwaiter pop() { return PopAwaiter(*this); }
+
+    bool tryPop(T& value) { return queue_.pop(value); }
+
+private:
+    E& executor_;
+    SPSCQueue<T, Capacity> queue_;
+    alignas(hardware_destructive_interference_size) std::atomic<void*> waiter_;
+};
+
+/*!
+ * Any number of producers and consumer coroutines over an MPMC queue
+ * (LockFreeQueue by default, anything with enqueue/dequeue/empty works).
+ *
+ * Waiters sit in a TaggedLockFreeQueue in FIFO order. A push dequeues one
+ * waiter and moves the value straight into it before scheduling it, so each
+ * pushed value resumes exactly one coroutine and a resumed coroutine never
+ * finds the queue empty.
+ */
+template <typename T, Executor E, typename Queue = LockFreeQueue<T>>
+class AsyncQueue {
+    struct Waiter {
+        std::coroutine_handle<> handle_;
+        T value_{};
+    };
+
+public:
+    explicit AsyncQueue(E& executor) : executor_(executor) {}
+
+    void push(T const& value) {
+        queue_.enqueue(value);
+        handshake();
+        if (!waiters_.empty()) resumeOne();
+    }
+
+    class PopAwaiter : private Waiter {
+    public:
+        explicit PopAwaiter(AsyncQueue& queue) : queue_(queue) {}
+
+        bool await_ready() { return queue_.queue_.dequeue(this->value_); }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            AsyncQueue& queue = queue_;
+            this->handle_ = handle;
+            queue.waiters_.enqueue(static_cast<Waiter*>(this));
+            queue.handshake();
+
+            // A value may have been pushed before we were visible. Serve
+            // whichever waiter is first in line, possibly us; this awaiter
+            // must not be touched any more.
+            if (!queue.queue_.empty()) queue.resumeOne();
+        }
+
+        T await_resume() { return std::move(this->value_); }
+
+    private:
+        AsyncQueue& queue_;
+    };
+
+    PopAwaiter pop() { return PopAwaiter(*this); }
+
+    bool tryPop(T& value) { return queue_.dequeue(value); }
+
+private:
+    void handshake() { handshake_.fetch_add(1, std::memory_order_acq_rel); }
+
+    void resumeOne() {
+        for (;;) {
+            Waiter* waiter;
+            if (!waiters_.dequeue(waiter)) return;
+
+            if (queue_.dequeue(waiter->value_)) {
+                executor_.schedule(waiter->handle_);
+                return;
+            }
+
+            // Another consumer took the value. Put the waiter back, then
+            // re-check: a push that ran while it was out saw no waiters.
+            waiters_.enqueue(waiter);
+            handshake();
+            if (queue_.empty()) return;
+        }
+    }
+
+private:
+    E& executor_;
+    Queue queue_;
+    TaggedLockFreeQueue<Waiter*> waiters_;
+    alignas(hardware_destructive_interference_size) std::atomic<uint64_t> handshake_{0};
+};
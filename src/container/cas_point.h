@@ -0,0 +1,35 @@
+#pragma once
+
+/*!
+ * Schedule perturbation hook for the lock-free containers.
+ *
+ * Every window between reading shared state and publishing a CAS/store based
+ * on it is marked with LOCK_FREE_CAS_POINT(). Normal builds compile it away;
+ * builds with LOCK_FREE_STRESS defined randomly spin or yield there so the
+ * stress tests hit interleavings (ABA, reclamation races) that a quiet
+ * scheduler almost never produces.
+ */
+
+#ifdef LOCK_FREE_STRESS
+#include <functional>
+#include <random>
+#include <thread>
+
+inline void casPoint() {
+    thread_local std::minstd_rand random(
+        static_cast<unsigned>(std::hash<std::thread::id>()(std::this_thread::get_id())));
+
+    unsigned const roll = random() % 64;
+    if (roll == 0) {
+        std::this_thread::yield();
+    } else if (roll < 8) {
+        volatile unsigned sink = 0;
+        for (unsigned spin = 0; spin < roll * 32; ++spin) sink = spin;
+        (void)sink;
+    }
+}
+
+#define LOCK_FREE_CAS_POINT() casPoint()
+#else
+#define LOCK_FREE_CAS_POINT() ((void)0)
+#endif
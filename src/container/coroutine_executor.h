@@ -0,0 +1,137 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <thread>
+#include <vector>
+
+#include "lock_free_queue.h"
+
+/*!
+ * Minimal executors for the awaitable queues in async_queue.h.
+ * An executor only has to resume coroutine handles handed to schedule(),
+ * which may be called from any thread.
+ */
+template <typename E>
+concept Executor = requires(E executor, std::coroutine_handle<> handle) {
+    executor.schedule(handle);
+};
+
+/*!
+ * Fire-and-forget coroutine. It starts suspended and runs once spawned on an
+ * executor; the frame frees itself when the coroutine finishes.
+ */
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() {
+            return DetachedTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+template <Executor E>
+void spawn(E& executor, DetachedTask task) {
+    executor.schedule(task.handle_);
+}
+
+/*!
+ * Single-threaded executor: handles pile up in a lock-free queue and run on
+ * whichever thread calls run()/runOne(), in FIFO order.
+ */
+class ManualExecutor {
+public:
+    void schedule(std::coroutine_handle<> handle) {
+        ready_.enqueue(handle.address());
+    }
+
+    bool runOne() {
+        void* address;
+        if (!ready_.dequeue(address)) return false;
+        std::coroutine_handle<>::from_address(address).resume();
+        return true;
+    }
+
+    /*!
+     * Run until nothing is ready; returns the number of resumed coroutines.
+     */
+    std::size_t run() {
+        std::size_t count = 0;
+        while (runOne()) ++count;
+        return count;
+    }
+
+private:
+    TaggedLockFreeQueue<void*> ready_;
+};
+
+/*!
+ * Fixed pool of threads resuming scheduled coroutines. Idle threads park on
+ * an epoch counter with C++20 atomic wait/notify; schedule() only pays for a
+ * notify when somebody is actually parked.
+ * Coroutines still suspended when the pool is destroyed are not resumed.
+ */
+class ThreadPoolExecutor {
+public:
+    explicit ThreadPoolExecutor(unsigned threads = std::thread::hardware_concurrency()) {
+        threads = std::max(threads, 1u);
+        for (unsigned i = 0; i < threads; ++i) {
+            workers_.emplace_back([this] { work(); });
+        }
+    }
+
+    ~ThreadPoolExecutor() {
+        stop_.store(true);
+        epoch_.fetch_add(1);
+        epoch_.notify_all();
+        for (auto& worker : workers_) worker.join();
+    }
+
+    ThreadPoolExecutor(ThreadPoolExecutor const&) = delete;
+    ThreadPoolExecutor& operator = (ThreadPoolExecutor const&) = delete;
+
+    void schedule(std::coroutine_handle<> handle) {
+        ready_.enqueue(handle.address());
+        // seq_cst pairs with the sleeper registration in work(): either the
+        // sleeper sees the new epoch or we see the sleeper.
+        epoch_.fetch_add(1);
+        if (sleepers_.load() > 0) epoch_.notify_one();
+    }
+
+private:
+    static constexpr int SpinsBeforePark = 64;
+
+    void work() {
+        int idle = 0;
+        while (!stop_.load(std::memory_order_relaxed)) {
+            uint64_t const epoch = epoch_.load();
+            void* address;
+            if (ready_.dequeue(address)) {
+                std::coroutine_handle<>::from_address(address).resume();
+                idle = 0;
+            } else if (++idle < SpinsBeforePark) {
+                std::this_thread::yield();
+            } else {
+                sleepers_.fetch_add(1);
+                epoch_.wait(epoch);
+                sleepers_.fetch_sub(1);
+                idle = 0;
+            }
+        }
+    }
+
+private:
+    TaggedLockFreeQueue<void*> ready_;
+    std::atomic<uint64_t> epoch_{0};
+    std::atomic<uint32_t> sleepers_{0};
+    std::atomic<bool> stop_{false};
+    std::vector<std::thread> workers_;
+};
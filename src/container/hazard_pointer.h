@@ -1,7 +1,11 @@
 #pragma once
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <concepts>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 constexpr std::size_t MaxHazardPointers = 100;
 
@@ -66,10 +70,14 @@ std::atomic<Node<T>*>& getHazardPointer()
     return pointer.get();
 }
 
+/*!
+ * Must follow the unlink of node in the seq_cst order: pairs with the
+ * store-then-validate of a reader publishing its hazard pointer.
+ */
 template<typename T>
 bool isUsing(Node<T>* node) {
     for (size_t i = 0; i < MaxHazardPointers; ++i) {
-        if (HazardPointers<T>[i].pointer_.load() == node) return true;
+        if (HazardPointers<T>[i].pointer_.load(std::memory_order_seq_cst) == node) return true;
     }
     return false;
 }
@@ -88,7 +96,7 @@ private:
     };
 
     void addToRetiredNodes(RetiredNode* node) {
-        node->next_ = retiredNodes_.load();
+        node->next_ = retiredNodes_.load(std::memory_order_relaxed);
         while(!retiredNodes_.compare_exchange_strong(node->next_, node,
                                                 std::memory_order_release,
                                                 std::memory_order_relaxed));
@@ -97,12 +105,24 @@ private:
 public:
     RetiredList() : retiredNodes_ (nullptr) {}
 
+    /*!
+     * The owning queue is being destroyed, nobody holds these nodes any more.
+     */
+    ~RetiredList() {
+        RetiredNode* current = retiredNodes_.load(std::memory_order_acquire);
+        while (nullptr != current) {
+            RetiredNode* const next = current->next_;
+            delete current;
+            current = next;
+        }
+    }
+
     void addNode(Node* node) {
         addToRetiredNodes(new RetiredNode(node));
     }
 
     void deleteUnusedNodes() {
-        RetiredNode* current = retiredNodes_.exchange(nullptr);
+        RetiredNode* current = retiredNodes_.exchange(nullptr, std::memory_order_acquire);
         while (nullptr != current) {
             RetiredNode* const next = current->next_;
             if (!isUsing(current->node_)) delete current;
@@ -115,3 +135,207 @@ private:
     std::atomic<RetiredNode*> retiredNodes_;
 };
 
+
+/*!
+ * Retirement that never frees on the retiring thread.
+ *
+ * Retired nodes go into a thread-local batch; a full batch is handed off to
+ * a lock-free list shared by every queue of T (like the hazard pointers).
+ * collect(), called explicitly or by a ReclaimerThread, snapshots the hazard
+ * pointers once and frees every handed-off node nobody protects. Emptied
+ * batches go back to the retiring threads, so in the steady state retire()
+ * neither allocates nor frees.
+ *
+ * A node unlinked with a seq_cst CAS happens-before the scan through the
+ * release push / acquire exchange of the handoff list, which keeps the
+ * unlink-then-scan half of the hazard pointer handshake intact.
+ */
+template <typename T>
+class DeferredRetiredList {
+    static constexpr std::size_t BatchSize = 64;
+
+    struct Batch {
+        Node<T>* nodes_[BatchSize];
+        std::size_t count_ = 0;
+        Batch* next_ = nullptr;
+    };
+
+    class LocalBatch {
+    public:
+        explicit LocalBatch(DeferredRetiredList& list) : list_(list) {}
+
+        ~LocalBatch() {
+            flush();
+            delete current_;
+            while (nullptr != spares_) {
+                Batch* const next = spares_->next_;
+                delete spares_;
+                spares_ = next;
+            }
+        }
+
+        void retire(Node<T>* node) {
+            if (nullptr == current_) current_ = takeBatch();
+            current_->nodes_[current_->count_++] = node;
+            if (BatchSize == current_->count_) {
+                push(list_.handoff_, current_);
+                current_ = nullptr;
+            }
+        }
+
+        void flush() {
+            if (nullptr != current_ && current_->count_ > 0) {
+                push(list_.handoff_, current_);
+                current_ = nullptr;
+            }
+        }
+
+    private:
+        Batch* takeBatch() {
+            // Taking the whole list with exchange is ABA-free.
+            if (nullptr == spares_) spares_ = list_.spares_.exchange(nullptr, std::memory_order_acquire);
+            if (nullptr == spares_) return new Batch();
+
+            Batch* const batch = spares_;
+            spares_ = batch->next_;
+            batch->next_ = nullptr;
+            return batch;
+        }
+
+    private:
+        DeferredRetiredList& list_;
+        Batch* current_ = nullptr;
+        Batch* spares_ = nullptr;
+    };
+
+public:
+    DeferredRetiredList() : handoff_(nullptr), spares_(nullptr) {}
+
+    /*!
+     * Runs at exit, when no thread uses the queues any more.
+     */
+    ~DeferredRetiredList() {
+        for (Batch* batch : {handoff_.load(), spares_.load()}) {
+            while (nullptr != batch) {
+                Batch* const next = batch->next_;
+                for (std::size_t i = 0; i < batch->count_; ++i) delete batch->nodes_[i];
+                delete batch;
+                batch = next;
+            }
+        }
+        for (Node<T>* node : kept_) delete node;
+    }
+
+    DeferredRetiredList(DeferredRetiredList const&) = delete;
+    DeferredRetiredList& operator = (DeferredRetiredList const&) = delete;
+
+    /*!
+     * @p node must already be unlinked.
+     */
+    void retire(Node<T>* node) { local().retire(node); }
+
+    /*!
+     * Hand off the calling thread's partial batch, e.g. before collect().
+     * Threads do it themselves when they exit.
+     */
+    void flush() { local().flush(); }
+
+    /*!
+     * Free every handed-off node no hazard pointer protects; returns how
+     * many were freed. Protected nodes are kept for the next call.
+     */
+    std::size_t collect();
+
+private:
+    LocalBatch& local() {
+        thread_local LocalBatch batch(*this);
+        return batch;
+    }
+
+    static void push(std::atomic<Batch*>& list, Batch* batch) {
+        batch->next_ = list.load(std::memory_order_relaxed);
+        while (!list.compare_exchange_weak(batch->next_, batch,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed));
+    }
+
+private:
+    std::atomic<Batch*> handoff_;
+    std::atomic<Batch*> spares_;
+
+    // Collector side
+    std::mutex collectMutex_;
+    std::vector<Node<T>*> kept_;
+    std::vector<Node<T>*> protected_;
+};
+
+template <typename T>
+std::size_t DeferredRetiredList<T>::collect() {
+    std::lock_guard<std::mutex> lock(collectMutex_);
+    Batch* batch = handoff_.exchange(nullptr, std::memory_order_acquire);
+    if (nullptr == batch && kept_.empty()) return 0;
+
+    protected_.clear();
+    for (std::size_t i = 0; i < MaxHazardPointers; ++i) {
+        if (Node<T>* node = HazardPointers<T>[i].pointer_.load(std::memory_order_seq_cst)) {
+            protected_.push_back(node);
+        }
+    }
+    std::sort(protected_.begin(), protected_.end());
+
+    std::size_t freed = 0;
+    auto reclaim = [&](Node<T>* node, std::vector<Node<T>*>& kept) {
+        if (std::binary_search(protected_.begin(), protected_.end(), node)) {
+            kept.push_back(node);
+        } else {
+            delete node;
+            ++freed;
+        }
+    };
+
+    std::vector<Node<T>*> kept;
+    for (Node<T>* node : kept_) reclaim(node, kept);
+    kept_.swap(kept);
+
+    while (nullptr != batch) {
+        Batch* const next = batch->next_;
+        for (std::size_t i = 0; i < batch->count_; ++i) reclaim(batch->nodes_[i], kept_);
+        batch->count_ = 0;
+        push(spares_, batch);
+        batch = next;
+    }
+    return freed;
+}
+
+template <typename T>
+inline DeferredRetiredList<T> DeferredRetired;
+
+/*!
+ * Calls DeferredRetired<T>.collect() every @p interval on its own thread,
+ * and once more when stopped.
+ */
+template <typename T>
+class ReclaimerThread {
+public:
+    explicit ReclaimerThread(std::chrono::microseconds interval = std::chrono::microseconds(100))
+        : stop_(false), thread_([this, interval] {
+            while (!stop_.load(std::memory_order_relaxed)) {
+                DeferredRetired<T>.collect();
+                std::this_thread::sleep_for(interval);
+            }
+        }) {
+    }
+
+    ~ReclaimerThread() {
+        stop_.store(true, std::memory_order_relaxed);
+        thread_.join();
+        DeferredRetired<T>.collect();
+    }
+
+    ReclaimerThread(ReclaimerThread const&) = delete;
+    ReclaimerThread& operator = (ReclaimerThread const&) = delete;
+
+private:
+    std::atomic<bool> stop_;
+    std::thread thread_;
+};
@@ -0,0 +1,587 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "cas_point.h"
+
+/*!
+ * Persistent, memory-mapped append-only journal (Chronicle-Queue style).
+ *
+ * The journal is a directory of fixed-size segment files. Each segment starts
+ * with a SegmentHeader page, followed by the records. A record is an 8-byte
+ * word (length | state) followed by the payload, 8-byte aligned. A writer
+ * reserves a record by CAS-ing the first Empty word after the existing
+ * records to Pending, so appends from any number of threads are lock-free
+ * and every reserved byte is labelled: there is never an unwritten gap in
+ * front of a committed record.
+ * One JournalQueue at a time owns the directory (an exclusive flock), since
+ * opening it recovers the records other writers left Pending. Readers in
+ * any process may tail it meanwhile.
+ *
+ *   state Pending      reserved, payload being written
+ *         Committed    complete; readers may consume it
+ *         EndOfSegment the rest of the segment is unused, go to the next one
+ *         Abandoned    a Pending record found after a crash, skipped
+ *
+ * Once a segment is sealed and every reservation in it committed, the writer
+ * marks it finished and unmaps it. Recovery only has to scan the segments
+ * that were not finished, starting from the oldest one still open when the
+ * newest segment was created (its header's oldestUnfinished).
+ *
+ * Readers follow a position through the mapped segments with plain loads;
+ * a syscall is only needed to map the next segment.
+ * Durability is up to the page cache unless JournalOptions asks for batched
+ * msync/fdatasync.
+ */
+
+constexpr uint64_t JournalMagic = 0x4c414e52554f4a4cull;   // "LJOURNAL"
+constexpr std::size_t JournalHeaderSize = 4096;
+constexpr std::size_t JournalRecordHeaderSize = 8;
+
+enum class JournalRecordState : uint32_t {
+    Empty = 0,
+    Pending = 1,
+    Committed = 2,
+    EndOfSegment = 3,
+    Abandoned = 4,
+};
+
+struct SegmentHeader {
+    uint64_t magic;             // stored last when a segment is created
+    uint64_t index;
+    uint64_t segmentSize;
+    uint64_t writePosition;     // hint: every record before it is reserved
+    uint64_t oldestUnfinished;  // every older segment was finished at creation
+    uint64_t finished;          // 1: sealed, and no record is Pending
+};
+
+enum class SyncMode {
+    None,       // leave write-back to the kernel
+    Async,      // msync(MS_ASYNC): schedule write-back
+    Sync,       // fdatasync: wait until the data is on disk
+};
+
+struct JournalOptions {
+    std::size_t segmentSize = 64 << 20;
+    SyncMode syncMode = SyncMode::None;
+    std::size_t syncEveryRecords = 0;   // 0: only on explicit sync()
+};
+
+struct JournalPosition {
+    uint64_t segment;
+    uint64_t offset;
+
+    bool operator == (JournalPosition const&) const = default;
+};
+
+inline uint64_t packJournalRecord(uint32_t length, JournalRecordState state) {
+    return static_cast<uint64_t>(state) << 32 | length;
+}
+
+inline std::size_t journalRecordSize(std::size_t length) {
+    return (JournalRecordHeaderSize + length + 7) & ~std::size_t(7);
+}
+
+inline std::filesystem::path journalSegmentPath(std::filesystem::path const& directory, uint64_t index) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "segment-%010llu.journal", static_cast<unsigned long long>(index));
+    return directory / name;
+}
+
+/*!
+ * One mapped segment file.
+ */
+class JournalSegment {
+public:
+    /*!
+     * Create and initialize a new segment file. The magic is stored last, so
+     * a reader never maps a half-initialized header.
+     */
+    static std::unique_ptr<JournalSegment> create(std::filesystem::path const& directory, uint64_t index,
+                                                  std::size_t segmentSize, uint64_t oldestUnfinished) {
+        auto path = journalSegmentPath(directory, index);
+        int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (fd < 0) throw std::system_error(errno, std::generic_category(), "open " + path.string());
+
+        if (ftruncate(fd, segmentSize) != 0) {
+            int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "ftruncate " + path.string());
+        }
+
+        auto segment = std::unique_ptr<JournalSegment>(new JournalSegment(fd, segmentSize, false));
+        SegmentHeader* header = segment->header();
+        header->index = index;
+        header->segmentSize = segmentSize;
+        header->oldestUnfinished = oldestUnfinished;
+        segment->writePosition().store(JournalHeaderSize, std::memory_order_relaxed);
+        std::atomic_ref<uint64_t>(header->magic).store(JournalMagic, std::memory_order_release);
+        return segment;
+    }
+
+    /*!
+     * Map an existing segment; nullptr if it does not exist (yet).
+     */
+    static std::unique_ptr<JournalSegment> open(std::filesystem::path const& directory,
+                                                uint64_t index, bool readOnly) {
+        auto path = journalSegmentPath(directory, index);
+        int fd = ::open(path.c_str(), (readOnly ? O_RDONLY : O_RDWR) | O_CLOEXEC);
+        if (fd < 0) {
+            if (errno == ENOENT) return nullptr;
+            throw std::system_error(errno, std::generic_category(), "open " + path.string());
+        }
+
+        struct stat status;
+        if (fstat(fd, &status) != 0 || static_cast<std::size_t>(status.st_size) < JournalHeaderSize) {
+            // Created but not truncated yet by its creator.
+            ::close(fd);
+            return nullptr;
+        }
+
+        auto segment = std::unique_ptr<JournalSegment>(new JournalSegment(fd, status.st_size, readOnly));
+        if (std::atomic_ref<uint64_t>(segment->header()->magic).load(std::memory_order_acquire) != JournalMagic) {
+            return nullptr;
+        }
+        return segment;
+    }
+
+    ~JournalSegment() {
+        munmap(data_, size_);
+        ::close(fd_);
+    }
+
+    JournalSegment(JournalSegment const&) = delete;
+    JournalSegment& operator = (JournalSegment const&) = delete;
+
+    uint64_t index() const { return header()->index; }
+    std::size_t size() const { return size_; }
+    std::byte* data() const { return data_; }
+
+    SegmentHeader* header() const { return reinterpret_cast<SegmentHeader*>(data_); }
+
+    std::atomic_ref<uint64_t> writePosition() const {
+        return std::atomic_ref<uint64_t>(header()->writePosition);
+    }
+
+    std::atomic_ref<uint64_t> oldestUnfinished() const {
+        return std::atomic_ref<uint64_t>(header()->oldestUnfinished);
+    }
+
+    std::atomic_ref<uint64_t> finished() const {
+        return std::atomic_ref<uint64_t>(header()->finished);
+    }
+
+    std::atomic_ref<uint64_t> recordWord(uint64_t offset) const {
+        return std::atomic_ref<uint64_t>(*reinterpret_cast<uint64_t*>(data_ + offset));
+    }
+
+    void sync(SyncMode mode) const {
+        if (mode == SyncMode::Async) msync(data_, size_, MS_ASYNC);
+        else if (mode == SyncMode::Sync) fdatasync(fd_);
+    }
+
+private:
+    JournalSegment(int fd, std::size_t size, bool readOnly) : fd_(fd), size_(size) {
+        void* data = mmap(nullptr, size, readOnly ? PROT_READ : PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (MAP_FAILED == data) {
+            int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "mmap");
+        }
+        data_ = static_cast<std::byte*>(data);
+    }
+
+private:
+    int fd_;
+    std::size_t size_;
+    std::byte* data_;
+};
+
+class JournalQueue {
+public:
+    /*!
+     * Open the journal in @p directory, creating it if needed. An existing
+     * journal is recovered first: records left Pending by a crashed writer
+     * become Abandoned, and appends continue after the last record.
+     * Throws std::runtime_error if another JournalQueue, in this or another
+     * process, has the directory open.
+     */
+    explicit JournalQueue(std::filesystem::path directory, JournalOptions const& options = {})
+        : directory_(std::move(directory)), options_(options), current_(nullptr) {
+        long const pageSize = sysconf(_SC_PAGESIZE);
+        if (options_.segmentSize % pageSize != 0 || options_.segmentSize < 2 * JournalHeaderSize) {
+            throw std::invalid_argument("Segment size must be a multiple of the page size");
+        }
+        std::filesystem::create_directories(directory_);
+
+        lockFd_ = ::open(directory_.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (lockFd_ < 0) throw std::system_error(errno, std::generic_category(), "open " + directory_.string());
+        if (flock(lockFd_, LOCK_EX | LOCK_NB) != 0) {
+            int error = errno;
+            ::close(lockFd_);
+            if (error == EWOULDBLOCK) throw std::runtime_error("Journal " + directory_.string() + " is already open");
+            throw std::system_error(error, std::generic_category(), "flock " + directory_.string());
+        }
+
+        try {
+            recover();
+        } catch (...) {
+            ::close(lockFd_);
+            throw;
+        }
+    }
+
+    ~JournalQueue() {
+        segments_.clear();
+        ::close(lockFd_);
+    }
+
+    JournalQueue(JournalQueue const&) = delete;
+    JournalQueue& operator = (JournalQueue const&) = delete;
+
+    std::size_t maxRecordSize() const {
+        return options_.segmentSize - JournalHeaderSize - JournalRecordHeaderSize;
+    }
+
+    /*!
+     * Append a record and return its position. Thread safe and lock-free
+     * except when the append rolls over to a new segment.
+     */
+    JournalPosition append(std::span<std::byte const> payload);
+
+    /*!
+     * Flush the segments that are still mapped according to syncMode
+     * (fdatasync when syncMode is None). Finished segments were flushed
+     * according to syncMode when they were unmapped.
+     */
+    void sync() {
+        std::lock_guard<std::mutex> lock(rollMutex_);
+        SyncMode mode = options_.syncMode == SyncMode::None ? SyncMode::Sync : options_.syncMode;
+        for (std::size_t i = firstOpen_; i < segments_.size(); ++i) {
+            if (!enter(*segments_[i])) continue;
+            segments_[i]->segment->sync(mode);
+            leave(*segments_[i]);
+        }
+    }
+
+private:
+    /*!
+     * A segment this journal mapped. users counts the appends (and syncs)
+     * working in it; once it is sealed and the last of them leaves, the
+     * segment is finished and unmapped. The OpenSegment itself is kept: an
+     * append that stalled right after loading current_ may still look at it.
+     */
+    struct OpenSegment {
+        OpenSegment(uint64_t index, std::unique_ptr<JournalSegment> segment)
+            : index(index), segment(std::move(segment)) {}
+
+        uint64_t const index;
+        std::unique_ptr<JournalSegment> segment;
+        std::atomic<bool> sealed{false};
+        alignas(64) std::atomic<uint64_t> users{0};
+    };
+
+    static constexpr uint64_t Unmapped = uint64_t(1) << 63;
+
+    /*!
+     * Pin @p open while working in it; false if it is already unmapped.
+     */
+    static bool enter(OpenSegment& open) {
+        if (0 == (open.users.fetch_add(1) & Unmapped)) return true;
+        open.users.fetch_sub(1);
+        return false;
+    }
+
+    void leave(OpenSegment& open) {
+        // seq_cst on both sides: either we see sealed, or roll() sees us gone.
+        if (1 == open.users.fetch_sub(1) && open.sealed.load()) finish(open);
+    }
+
+    void finish(OpenSegment& open);
+
+    void recover();
+
+    /*!
+     * Scan a segment record by record and return the offset after the last
+     * record, or nullopt if the segment was sealed with EndOfSegment.
+     */
+    std::optional<uint64_t> recoverSegment(JournalSegment& segment);
+
+    /*!
+     * Claim the record after the last one in @p segment; nullopt if the
+     * segment is (now) sealed.
+     */
+    std::optional<uint64_t> reserve(JournalSegment& segment, uint32_t length);
+
+    static void advanceWritePosition(JournalSegment& segment, uint64_t position);
+
+    void roll(OpenSegment* full);
+
+    void syncBatch(JournalSegment& segment) {
+        if (options_.syncEveryRecords == 0 || options_.syncMode == SyncMode::None) return;
+        if (unsynced_.fetch_add(1, std::memory_order_relaxed) + 1 >= options_.syncEveryRecords) {
+            unsynced_.store(0, std::memory_order_relaxed);
+            segment.sync(options_.syncMode);
+        }
+    }
+
+private:
+    std::filesystem::path directory_;
+    JournalOptions options_;
+    int lockFd_;
+
+    std::mutex rollMutex_;
+    std::vector<std::unique_ptr<OpenSegment>> segments_;   // oldest first
+    std::size_t firstOpen_ = 0;                             // segments_ before it are finished
+    std::atomic<OpenSegment*> current_;
+    std::atomic<std::size_t> unsynced_{0};
+};
+
+inline JournalPosition JournalQueue::append(std::span<std::byte const> payload) {
+    if (payload.size() > maxRecordSize()) {
+        throw std::invalid_argument("Record does not fit in a journal segment");
+    }
+
+    uint32_t const length = static_cast<uint32_t>(payload.size());
+
+    for (;;) {
+        OpenSegment* open = current_.load(std::memory_order_acquire);
+        // Only fails if current_ moved on and the segment was finished since.
+        if (!enter(*open)) continue;
+
+        JournalSegment& segment = *open->segment;
+        if (auto offset = reserve(segment, length)) {
+            std::memcpy(segment.data() + *offset + JournalRecordHeaderSize, payload.data(), payload.size());
+            LOCK_FREE_CAS_POINT();
+            segment.recordWord(*offset).store(packJournalRecord(length, JournalRecordState::Committed),
+                                              std::memory_order_release);
+            syncBatch(segment);
+            leave(*open);
+            return JournalPosition{open->index, *offset};
+        }
+        leave(*open);
+        roll(open);
+    }
+}
+
+inline std::optional<uint64_t> JournalQueue::reserve(JournalSegment& segment, uint32_t length) {
+    uint64_t const needed = journalRecordSize(length);
+    uint64_t offset = segment.writePosition().load(std::memory_order_acquire);
+
+    while (offset + JournalRecordHeaderSize <= segment.size()) {
+        uint64_t word = segment.recordWord(offset).load(std::memory_order_acquire);
+        auto const state = static_cast<JournalRecordState>(word >> 32);
+
+        if (state == JournalRecordState::EndOfSegment) return std::nullopt;
+        if (state != JournalRecordState::Empty) {
+            offset += journalRecordSize(static_cast<uint32_t>(word));
+            continue;
+        }
+
+        // The first Empty word is the end of the journal. Claim it for the
+        // record, or seal the segment if the record does not fit any more.
+        bool const fits = offset + needed <= segment.size();
+        uint64_t const claim = fits ? packJournalRecord(length, JournalRecordState::Pending)
+                                    : packJournalRecord(0, JournalRecordState::EndOfSegment);
+        LOCK_FREE_CAS_POINT();
+        if (!segment.recordWord(offset).compare_exchange_strong(word, claim, std::memory_order_acq_rel,
+                                                                std::memory_order_acquire)) {
+            continue;   // somebody else claimed it, look at what they wrote
+        }
+        if (!fits) return std::nullopt;
+
+        advanceWritePosition(segment, offset + needed);
+        return offset;
+    }
+    return std::nullopt;
+}
+
+inline void JournalQueue::advanceWritePosition(JournalSegment& segment, uint64_t position) {
+    uint64_t current = segment.writePosition().load(std::memory_order_relaxed);
+    while (current < position &&
+           !segment.writePosition().compare_exchange_weak(current, position, std::memory_order_release,
+                                                          std::memory_order_relaxed));
+}
+
+inline void JournalQueue::roll(OpenSegment* full) {
+    std::lock_guard<std::mutex> lock(rollMutex_);
+    if (current_.load(std::memory_order_relaxed) != full) return;
+
+    while (segments_[firstOpen_]->users.load() & Unmapped) ++firstOpen_;
+    uint64_t const index = full->index + 1;
+    segments_.push_back(std::make_unique<OpenSegment>(
+        index, JournalSegment::create(directory_, index, options_.segmentSize, segments_[firstOpen_]->index)));
+    current_.store(segments_.back().get(), std::memory_order_release);
+
+    full->sealed.store(true);
+    finish(*full);
+}
+
+inline void JournalQueue::finish(OpenSegment& open) {
+    uint64_t idle = 0;
+    if (!open.users.compare_exchange_strong(idle, Unmapped)) return;   // still in use, or done already
+
+    open.segment->finished().store(1, std::memory_order_release);
+    open.segment->sync(options_.syncMode);
+    open.segment.reset();
+}
+
+inline std::optional<uint64_t> JournalQueue::recoverSegment(JournalSegment& segment) {
+    uint64_t offset = JournalHeaderSize;
+
+    while (offset + JournalRecordHeaderSize <= segment.size()) {
+        uint64_t const word = segment.recordWord(offset).load(std::memory_order_acquire);
+        auto const state = static_cast<JournalRecordState>(word >> 32);
+        uint64_t const size = journalRecordSize(static_cast<uint32_t>(word));
+
+        if (state == JournalRecordState::EndOfSegment) return std::nullopt;
+        // Reservations are claimed in order, so the first Empty word is the end.
+        if (state == JournalRecordState::Empty || offset + size > segment.size()) break;
+
+        if (state == JournalRecordState::Pending) {
+            segment.recordWord(offset).store(
+                packJournalRecord(static_cast<uint32_t>(word), JournalRecordState::Abandoned),
+                std::memory_order_release);
+        }
+        offset += size;
+    }
+
+    // Nothing after offset was ever written, so there is nothing to clear.
+    segment.writePosition().store(offset, std::memory_order_release);
+    return offset;
+}
+
+inline void JournalQueue::recover() {
+    std::optional<uint64_t> last;
+    for (auto const& entry : std::filesystem::directory_iterator(directory_)) {
+        unsigned long long index;
+        if (std::sscanf(entry.path().filename().c_str(), "segment-%llu.journal", &index) == 1) {
+            last = std::max<uint64_t>(last.value_or(0), index);
+        }
+    }
+
+    if (!last) {
+        segments_.push_back(std::make_unique<OpenSegment>(
+            0, JournalSegment::create(directory_, 0, options_.segmentSize, 0)));
+        current_.store(segments_.back().get());
+        return;
+    }
+
+    // A writer that stalled mid-record may have held any segment open since
+    // the newest one was created, not just the previous one.
+    auto segment = JournalSegment::open(directory_, *last, false);
+    uint64_t oldest = 0;
+    if (segment) {
+        oldest = segment->oldestUnfinished().load();
+    } else if (*last > 0) {
+        // Crashed while creating the newest segment; its creator read the
+        // same bound from the previous one at the latest.
+        if (auto previous = JournalSegment::open(directory_, *last - 1, true)) {
+            oldest = previous->oldestUnfinished().load();
+        }
+    }
+
+    for (uint64_t index = std::min(oldest, *last); index < *last; ++index) {
+        auto older = JournalSegment::open(directory_, index, false);
+        if (nullptr == older || older->finished().load()) continue;
+        recoverSegment(*older);
+        older->finished().store(1, std::memory_order_release);
+    }
+
+    if (nullptr == segment) {
+        // Start the half-created segment over.
+        std::filesystem::remove(journalSegmentPath(directory_, *last));
+        segment = JournalSegment::create(directory_, *last, options_.segmentSize, *last);
+    }
+    segment->oldestUnfinished().store(*last);
+
+    bool const sealed = !recoverSegment(*segment);
+    segments_.push_back(std::make_unique<OpenSegment>(*last, std::move(segment)));
+    current_.store(segments_.back().get());
+    if (sealed) roll(current_.load());
+}
+
+/*!
+ * Tails a journal from a position. Records are read in place; a span stays
+ * valid until the next call to next().
+ */
+class JournalReader {
+public:
+    explicit JournalReader(std::filesystem::path directory,
+                           JournalPosition from = JournalPosition{0, JournalHeaderSize})
+        : directory_(std::move(directory)), position_(from) {
+    }
+
+    /*!
+     * The next committed record, or nullopt if the reader caught up with
+     * the writers (or the next record is still being written).
+     */
+    std::optional<std::span<std::byte const>> next();
+
+    JournalPosition position() const { return position_; }
+
+private:
+    void nextSegment() {
+        segment_.reset();
+        position_ = JournalPosition{position_.segment + 1, JournalHeaderSize};
+    }
+
+private:
+    std::filesystem::path directory_;
+    JournalPosition position_;
+    std::unique_ptr<JournalSegment> segment_;
+};
+
+inline std::optional<std::span<std::byte const>> JournalReader::next() {
+    for (;;) {
+        if (nullptr == segment_) {
+            segment_ = JournalSegment::open(directory_, position_.segment, true);
+            if (nullptr == segment_) return std::nullopt;
+        }
+
+        if (position_.offset + JournalRecordHeaderSize > segment_->size()) {
+            nextSegment();
+            continue;
+        }
+
+        uint64_t const word = segment_->recordWord(position_.offset).load(std::memory_order_acquire);
+        auto const state = static_cast<JournalRecordState>(word >> 32);
+        uint32_t const length = static_cast<uint32_t>(word);
+
+        switch (state) {
+        case JournalRecordState::Committed: {
+            std::span<std::byte const> record(segment_->data() + position_.offset + JournalRecordHeaderSize, length);
+            position_.offset += journalRecordSize(length);
+            return record;
+        }
+        case JournalRecordState::Abandoned:
+            position_.offset += journalRecordSize(length);
+            continue;
+        case JournalRecordState::EndOfSegment:
+            nextSegment();
+            continue;
+        default:
+            return std::nullopt;
+        }
+    }
+}
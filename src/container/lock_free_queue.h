@@ -1,47 +1,225 @@
 #pragma once
+#include <algorithm>
 #include <atomic>
-#include <iostream>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
 
-struct Node {
-    int value;
-    std::atomic<Node*> next;
-    Node(int val) : value(val), next(nullptr) {}
-};
+#include "cas_point.h"
 
+/*!
+ * Pointer plus version counter, swapped as one 128-bit word (cmpxchg16b on
+ * x86-64, build with -mcx16). Every successful CAS bumps the tag, so a node
+ * that was popped and recycled in between no longer compares equal: ABA is
+ * detected without hazard pointers or epochs.
+ */
+template <typename T>
+struct alignas(2 * sizeof(void*)) TaggedPointer {
+    T* pointer_;
+    uintptr_t tag_;
+
+    bool operator == (TaggedPointer const& other) const {
+        return pointer_ == other.pointer_ && tag_ == other.tag_;
+    }
+};
 
 /*!
- * Simple lock free queue without guard (ABA problems, no delay deletion)
+ * Michael-Scott queue with tagged pointers and a type-stable node pool.
+ *
+ * Nodes are never returned to the allocator while the queue lives; dequeued
+ * nodes go to a lock-free free list and are reused by later enqueues. A stale
+ * thread may therefore still read a recycled node, which is harmless because
+ * every field it reads is atomic and its CAS then fails on the tag.
+ * This rules out non trivially copyable payloads; use the hazard pointer
+ * LockFreeQueue for those.
+ * Pool chunks come from @p Allocator, e.g. NodeAllocator (utils/numa.h) to
+ * keep the whole pool on one NUMA node. Concurrent enqueues may grow the
+ * pool at the same time, so the allocator must be thread safe.
  */
+template <typename T, typename Allocator = std::allocator<T>>
+class TaggedLockFreeQueue {
+    static_assert(std::is_trivially_copyable_v<T>, "T is read racily from recycled nodes");
+    static_assert(std::atomic<T>::is_always_lock_free);
+
+    struct PoolNode;
+    using Pointer = TaggedPointer<PoolNode>;
+
+    struct PoolNode {
+        std::atomic<T> value_;
+        std::atomic<Pointer> next_;
+        PoolNode() : value_(T()), next_(Pointer{nullptr, 0}) {}
+    };
+
+    struct Chunk {
+        PoolNode* nodes_;
+        Chunk* next_;
+    };
+
+    using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<PoolNode>;
+    using NodeTraits = std::allocator_traits<NodeAllocator>;
 
-class LockFreeQueue {
 public:
-    LockFreeQueue() {
-        Node* dummy = new Node(-1);
-        head.store(dummy);
-        tail.store(dummy);
+    static constexpr std::size_t ChunkSize = 1024;
+
+    explicit TaggedLockFreeQueue(std::size_t initialCapacity = ChunkSize, Allocator const& allocator = Allocator())
+        : allocator_(allocator), chunks_(nullptr), freeList_(Pointer{nullptr, 0}) {
+        while (initialCapacity > 0) {
+            addChunk();
+            initialCapacity -= std::min(initialCapacity, ChunkSize);
+        }
+        PoolNode* dummy = allocate();
+        head_.store(Pointer{dummy, 0});
+        tail_.store(Pointer{dummy, 0});
+    }
+
+    ~TaggedLockFreeQueue() {
+        Chunk* chunk = chunks_.load();
+        while (nullptr != chunk) {
+            Chunk* next = chunk->next_;
+            for (std::size_t i = 0; i < ChunkSize; ++i) NodeTraits::destroy(allocator_, &chunk->nodes_[i]);
+            NodeTraits::deallocate(allocator_, chunk->nodes_, ChunkSize);
+            delete chunk;
+            chunk = next;
+        }
+    }
+
+    TaggedLockFreeQueue(TaggedLockFreeQueue const&) = delete;
+    TaggedLockFreeQueue& operator = (TaggedLockFreeQueue const&) = delete;
+
+    void enqueue(T const& value);
+
+    bool dequeue(T& result);
+
+    /*!
+     * Exact at some instant during the call: like dequeue(), next only counts
+     * if head did not move while it was read, otherwise the old head may have
+     * been recycled and next be a free-list link.
+     */
+    bool empty() const {
+        for (;;) {
+            Pointer head = head_.load(std::memory_order_acquire);
+            Pointer next = head.pointer_->next_.load(std::memory_order_acquire);
+            if (head == head_.load(std::memory_order_acquire)) return nullptr == next.pointer_;
+        }
     }
 
-    void enqueue(int value) {
-        Node* newNode = new Node(value);
-        Node* oldTail;
-        do {
-            oldTail = tail.load();
-        } while (!tail.compare_exchange_weak(oldTail, newNode));
-        oldTail->next.store(newNode);
+private:
+    PoolNode* allocate();
+
+    void release(PoolNode* node) {
+        Pointer top = freeList_.load(std::memory_order_relaxed);
+        for (;;) {
+            Pointer next = node->next_.load(std::memory_order_relaxed);
+            node->next_.store(Pointer{top.pointer_, next.tag_ + 1}, std::memory_order_relaxed);
+            if (freeList_.compare_exchange_weak(top, Pointer{node, top.tag_ + 1},
+                                                std::memory_order_release,
+                                                std::memory_order_relaxed)) {
+                return;
+            }
+        }
     }
 
-    int dequeue() {
-        Node* oldHead;
-        do {
-            oldHead = head.load();
-            if (oldHead->next.load() == nullptr) return -1;
-        } while (!head.compare_exchange_weak(oldHead, oldHead->next.load()));
-        int value = oldHead->next.load()->value;
-        delete oldHead;
-        return value;
+    void addChunk() {
+        PoolNode* nodes = NodeTraits::allocate(allocator_, ChunkSize);
+        for (std::size_t i = 0; i < ChunkSize; ++i) NodeTraits::construct(allocator_, &nodes[i]);
+
+        auto chunk = new Chunk{nodes, chunks_.load(std::memory_order_relaxed)};
+        while (!chunks_.compare_exchange_weak(chunk->next_, chunk,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed));
+        for (std::size_t i = 0; i < ChunkSize; ++i) release(&chunk->nodes_[i]);
     }
 
 private:
-    std::atomic<Node*> head;
-    std::atomic<Node*> tail;
+    NodeAllocator allocator_;
+    alignas(64) std::atomic<Pointer> head_;
+    alignas(64) std::atomic<Pointer> tail_;
+    alignas(64) std::atomic<Chunk*> chunks_;
+    std::atomic<Pointer> freeList_;
 };
+
+template <typename T, typename Allocator>
+typename TaggedLockFreeQueue<T, Allocator>::PoolNode* TaggedLockFreeQueue<T, Allocator>::allocate() {
+    for (;;) {
+        Pointer top = freeList_.load(std::memory_order_acquire);
+        while (nullptr != top.pointer_) {
+            // top may be popped and reused meanwhile; the pool keeps it readable
+            // and the tag makes the CAS below fail in that case.
+            Pointer next = top.pointer_->next_.load(std::memory_order_relaxed);
+            LOCK_FREE_CAS_POINT();
+            if (freeList_.compare_exchange_weak(top, Pointer{next.pointer_, top.tag_ + 1},
+                                                std::memory_order_acquire,
+                                                std::memory_order_acquire)) {
+                top.pointer_->next_.store(Pointer{nullptr, next.tag_ + 1}, std::memory_order_relaxed);
+                return top.pointer_;
+            }
+        }
+        addChunk();
+    }
+}
+
+template <typename T, typename Allocator>
+void TaggedLockFreeQueue<T, Allocator>::enqueue(T const& value) {
+    PoolNode* node = allocate();
+    node->value_.store(value, std::memory_order_relaxed);
+
+    Pointer tail;
+    Pointer next;
+    for (;;) {
+        tail = tail_.load(std::memory_order_acquire);
+        next = tail.pointer_->next_.load(std::memory_order_acquire);
+        LOCK_FREE_CAS_POINT();
+
+        if (!(tail == tail_.load(std::memory_order_acquire))) continue;
+
+        if (nullptr == next.pointer_) {
+            if (tail.pointer_->next_.compare_exchange_weak(next, Pointer{node, next.tag_ + 1},
+                                                           std::memory_order_release,
+                                                           std::memory_order_relaxed)) {
+                break;
+            }
+        } else {
+            // Tail is lagging behind, help the enqueuer that linked next.
+            tail_.compare_exchange_weak(tail, Pointer{next.pointer_, tail.tag_ + 1},
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed);
+        }
+    }
+
+    tail_.compare_exchange_strong(tail, Pointer{node, tail.tag_ + 1},
+                                  std::memory_order_release,
+                                  std::memory_order_relaxed);
+}
+
+template <typename T, typename Allocator>
+bool TaggedLockFreeQueue<T, Allocator>::dequeue(T& result) {
+    Pointer head;
+    for (;;) {
+        head = head_.load(std::memory_order_acquire);
+        Pointer tail = tail_.load(std::memory_order_acquire);
+        Pointer next = head.pointer_->next_.load(std::memory_order_acquire);
+        LOCK_FREE_CAS_POINT();
+
+        if (!(head == head_.load(std::memory_order_acquire))) continue;
+
+        if (head.pointer_ == tail.pointer_) {
+            if (nullptr == next.pointer_) return false;
+            tail_.compare_exchange_weak(tail, Pointer{next.pointer_, tail.tag_ + 1},
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed);
+        } else {
+            // Read before the CAS: once head moves, next may be dequeued and recycled.
+            T value = next.pointer_->value_.load(std::memory_order_relaxed);
+            if (head_.compare_exchange_weak(head, Pointer{next.pointer_, head.tag_ + 1},
+                                            std::memory_order_acq_rel,
+                                            std::memory_order_relaxed)) {
+                result = value;
+                break;
+            }
+        }
+    }
+
+    release(head.pointer_);
+    return true;
+}
@@ -1,6 +1,9 @@
 #pragma once
 #include <atomic>
+#include <type_traits>
+#include "cas_point.h"
 #include "hazard_pointer.h"
+#include "queue_policy.h"
 
 template<typename T>
 struct Node {
@@ -21,8 +24,17 @@ struct Node {
     }
 };
 
-template<typename T, Nodeable Node = Node<T>>
+/*!
+ * MPMC queue with hazard pointer reclamation.
+ * Policy picks the memory orderings and the CAS backoff, see queue_policy.h.
+ */
+template<typename T, typename Policy = QueuePolicy<>, Nodeable Node = Node<T>>
 class LockFreeQueue {
+    using Ordering = typename Policy::ordering;
+    using Backoff = typename Policy::backoff;
+    static constexpr bool DeferReclamation =
+        std::is_same_v<typename Policy::reclamation, DeferredReclamation>;
+
 public:
     LockFreeQueue() {
         auto dummy = new Node();
@@ -47,20 +59,44 @@ public:
 
     size_t size() const { return size_.load(std::memory_order_relaxed); }
 
+    bool empty() const { return head_.load(Ordering::acquire) == tail_.load(Ordering::acquire); }
+
+    /*!
+     * With DeferredReclamation: free what the consumers of every
+     * LockFreeQueue<T> handed off so far (their partial batches excepted).
+     */
+    static std::size_t collect() { return DeferredRetired<T>.collect(); }
+
 private:
     bool tryInsertNewTail(Node* oldTail, Node* newTail) {
         Node* nullNode = nullptr;
+        LOCK_FREE_CAS_POINT();
         if (oldTail->next_.compare_exchange_strong(nullNode, newTail,
-                                                    std::memory_order_release,
-                                                    std::memory_order_relaxed)) {
-            tail_.store(newTail, std::memory_order_release);
-            size_.fetch_add(1, std::memory_order_relaxed);
+                                                    Ordering::release,
+                                                    Ordering::relaxed)) {
+            tail_.compare_exchange_strong(oldTail, newTail, Ordering::release, Ordering::relaxed);
+            size_.fetch_add(1, Ordering::relaxed);
             return true;
         } else {
+            helpAdvanceTail(oldTail);
             return false;
         }
     }
 
+    /*!
+     * Another thread linked oldTail->next_ but may not have moved tail_ yet.
+     * Moving it here keeps enqueue lock-free and guarantees that once
+     * enqueue() returns, tail_ is past the node holding the new value, so
+     * dequeue()/empty() see it.
+     * Without it, enqueuers spin on a stale tail_ until the preempted linker
+     * runs again; that, not CAS contention, was most of the retries
+     * mpmc_backoff_bench used to count.
+     */
+    void helpAdvanceTail(Node* oldTail) {
+        Node* next = oldTail->next_.load(Ordering::acquire);
+        tail_.compare_exchange_strong(oldTail, next, Ordering::release, Ordering::relaxed);
+    }
+
 private:
     std::atomic<Node*> head_;
     std::atomic<Node*> tail_;
@@ -68,72 +104,88 @@ private:
     RetiredList<T> retiredList_;
 };
 
-template<typename T, Nodeable Node>
-inline void LockFreeQueue<T, Node>::enqueue(T const& value) {
+template<typename T, typename Policy, Nodeable Node>
+inline void LockFreeQueue<T, Policy, Node>::enqueue(T const& value) {
     std::atomic<Node*>& hazardPointer = getHazardPointer<T>();
     Node* newTail = new Node();
     T* data = new T(value);
+    Backoff backoff;
 
     for (;;) {
-        Node* oldTail = tail_.load(std::memory_order_acquire);
+        Node* oldTail = tail_.load(Ordering::acquire);
         Node* tmpNode;
         do {
-            hazardPointer.store(nullptr);
             tmpNode = oldTail;
-            hazardPointer.store(oldTail);
-            oldTail = tail_.load(std::memory_order_acquire);
+            // Store-load handshake with the reclaimer's scan, see MinimalOrdering.
+            hazardPointer.store(oldTail, Ordering::protect);
+            LOCK_FREE_CAS_POINT();
+            oldTail = tail_.load(Ordering::protect);
         } while (oldTail != tmpNode);
 
         T* expectedValue = nullptr;
+        LOCK_FREE_CAS_POINT();
         if (oldTail->data_.compare_exchange_strong(expectedValue, data,
-                                                std::memory_order_release,
-                                                std::memory_order_relaxed)) {
+                                                Ordering::release,
+                                                Ordering::relaxed)) {
             if (!tryInsertNewTail(oldTail, newTail)) delete newTail;
 
+            hazardPointer.store(nullptr, Ordering::release);
             return;
         } else {
             if (tryInsertNewTail(oldTail, newTail)) {
                 newTail = new Node();
             }
+            backoff();
         }
     }
 }
 
-template <typename T, Nodeable Node>
-bool LockFreeQueue<T,Node>::dequeue(T& result) {
+template <typename T, typename Policy, Nodeable Node>
+bool LockFreeQueue<T, Policy, Node>::dequeue(T& result) {
     std::atomic<Node*>& hazardPointer = getHazardPointer<T>();
     Node* oldHead;
+    Backoff backoff;
 
     for (;;) {
-        oldHead = head_.load();
+        oldHead = head_.load(Ordering::acquire);
 
-        if (tail_.load(std::memory_order_acquire) == oldHead) return false;
+        if (tail_.load(Ordering::acquire) == oldHead) return false;
 
-        hazardPointer.store(oldHead);
+        hazardPointer.store(oldHead, Ordering::protect);
+        LOCK_FREE_CAS_POINT();
 
-        if (head_.load() != oldHead) {
-            hazardPointer.store(nullptr);
+        if (head_.load(Ordering::protect) != oldHead) {
+            hazardPointer.store(nullptr, Ordering::release);
+            backoff();
             continue;
         }
 
-        Node* nextHead = oldHead->next_.load();
+        Node* nextHead = oldHead->next_.load(Ordering::acquire);
+        LOCK_FREE_CAS_POINT();
 
+        // Unlinking is the reclaimer's half of the handshake, it precedes the
+        // isUsing() scan below.
         if(head_.compare_exchange_strong(oldHead, nextHead,
-                                        std::memory_order_release,
-                                        std::memory_order_relaxed)) {
-            auto data = oldHead->data_.load(std::memory_order_acquire);
+                                        Ordering::protect,
+                                        Ordering::relaxed)) {
+            auto data = oldHead->data_.load(Ordering::acquire);
             result = std::move(*data);
             break;
         }
+        backoff();
     }
 
-    hazardPointer.store(nullptr);
-    size_.fetch_sub(1, std::memory_order_relaxed);
+    hazardPointer.store(nullptr, Ordering::release);
+    size_.fetch_sub(1, Ordering::relaxed);
 
-    if (isUsing(oldHead)) retiredList_.addNode(oldHead);
-    else delete oldHead;
+    if constexpr (DeferReclamation) {
+        DeferredRetired<T>.retire(oldHead);
+    } else {
+        if (isUsing(oldHead)) retiredList_.addNode(oldHead);
+        else delete oldHead;
 
-    retiredList_.deleteUnusedNodes();
+        retiredList_.deleteUnusedNodes();
+    }
 
     return true;
 }
@@ -0,0 +1,106 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+/*!
+ * Compile-time policies for LockFreeQueue: the memory orderings its atomic
+ * operations use, what a thread does after losing a CAS race, and who frees
+ * dequeued nodes.
+ */
+
+/*!
+ * Minimum orderings the queue needs.
+ *
+ * Publishing data (payload CAS, linking a node) is release and everything
+ * that follows a pointer to it is acquire. The one place that needs more is
+ * the hazard pointer handshake: a reader stores its hazard pointer and then
+ * re-reads head_/tail_ to validate it, while a reclaimer unlinks a node and
+ * then scans the hazard pointers. Both sides are a store followed by a load
+ * of another location, which only seq_cst orders, so exactly those four
+ * operations use `protect`.
+ */
+struct MinimalOrdering {
+    static constexpr std::memory_order relaxed = std::memory_order_relaxed;
+    static constexpr std::memory_order acquire = std::memory_order_acquire;
+    static constexpr std::memory_order release = std::memory_order_release;
+    static constexpr std::memory_order protect = std::memory_order_seq_cst;
+};
+
+/*!
+ * Everything seq_cst. Slower, but handy to rule out an ordering bug when the
+ * stress tests fail.
+ */
+struct SeqCstOrdering {
+    static constexpr std::memory_order relaxed = std::memory_order_seq_cst;
+    static constexpr std::memory_order acquire = std::memory_order_seq_cst;
+    static constexpr std::memory_order release = std::memory_order_seq_cst;
+    static constexpr std::memory_order protect = std::memory_order_seq_cst;
+};
+
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#else
+    std::this_thread::yield();
+#endif
+}
+
+/*!
+ * Retry immediately; the behaviour the queue had before policies existed.
+ */
+struct NoBackoff {
+    void operator()() {}
+};
+
+/*!
+ * Truncated exponential backoff with jitter. Each failed CAS doubles the spin
+ * window up to MaxSpins, and the actual spin count is drawn from the window
+ * so contending threads spread out instead of retrying in lock step.
+ * One instance lives for one enqueue/dequeue call.
+ */
+template <unsigned MinSpins = 4, unsigned MaxSpins = 1024>
+class ExponentialBackoff {
+    static_assert(MinSpins > 0 && MinSpins <= MaxSpins);
+
+public:
+    void operator()() {
+        thread_local uint32_t random = 0x9e3779b9u ^
+            static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+        random ^= random << 13;
+        random ^= random >> 17;
+        random ^= random << 5;
+
+        unsigned const spins = 1 + random % limit_;
+        for (unsigned i = 0; i < spins; ++i) cpuRelax();
+        limit_ = std::min(limit_ * 2, MaxSpins);
+    }
+
+private:
+    unsigned limit_ = MinSpins;
+};
+
+/*!
+ * dequeue() frees the node it unlinked, or parks it on the queue's retired
+ * list while a hazard pointer protects it, and rescans that list every call.
+ */
+struct InlineReclamation {};
+
+/*!
+ * dequeue() only hands the node to DeferredRetired<T> (hazard_pointer.h);
+ * a ReclaimerThread or an explicit collect() scans and frees in bulk.
+ * Keeps free() and hazard scans off the consumers' latency.
+ */
+struct DeferredReclamation {};
+
+template <typename Ordering = MinimalOrdering, typename Backoff = NoBackoff,
+          typename Reclamation = InlineReclamation>
+struct QueuePolicy {
+    using ordering = Ordering;
+    using backoff = Backoff;
+    using reclamation = Reclamation;
+};
@@ -0,0 +1,306 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "cas_point.h"
+
+#ifndef hardware_destructive_interference_size
+#define hardware_destructive_interference_size 64
+#endif
+
+/*!
+ * Record header in front of every payload. Records start 8-byte aligned so
+ * the payload can be read in place as any type with alignment up to 8.
+ */
+struct RecordHeader {
+    uint32_t length;    // payload bytes
+    uint32_t type;      // user defined tag, PaddingType for wrap-around filler
+};
+
+// Reserved for the ring itself; reserve() rejects it as a user tag.
+constexpr uint32_t PaddingType = UINT32_MAX;
+constexpr std::size_t RecordAlignment = 8;
+
+static_assert(sizeof(RecordHeader) % RecordAlignment == 0);
+
+struct RecordView {
+    uint32_t type;
+    std::span<std::byte const> payload;
+
+    /*!
+     * The payload read in place as a T, or nullptr if it is too short to
+     * hold one (a truncated or mis-tagged record).
+     */
+    template <typename T>
+    T const* as() const {
+        static_assert(std::is_trivially_copyable_v<T> && alignof(T) <= RecordAlignment);
+        if (payload.size() < sizeof(T)) return nullptr;
+        return reinterpret_cast<T const*>(payload.data());
+    }
+};
+
+/*!
+ * Ring bytes stored inline, like SPSCQueue's buffer. A record that does not
+ * fit before the end of the buffer is preceded by a padding record and
+ * starts over at offset 0, so the largest record is half the capacity.
+ */
+template <std::size_t Capacity>
+class InlineRingStorage {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+    static_assert(Capacity >= 2 * sizeof(RecordHeader));
+
+public:
+    static constexpr bool IsMirrored = false;
+
+    std::byte* data() { return buffer_.data(); }
+    std::size_t capacity() const { return Capacity; }
+
+private:
+    alignas(hardware_destructive_interference_size) std::array<std::byte, Capacity> buffer_;
+};
+
+/*!
+ * The same memfd mapped twice, back to back: bytes written past the end of
+ * the first mapping land at the start of the ring. Records never need to be
+ * split or padded and may use the whole capacity.
+ * Capacity must be a power of 2 and a multiple of the page size.
+ */
+class MirroredRingStorage {
+public:
+    static constexpr bool IsMirrored = true;
+
+    explicit MirroredRingStorage(std::size_t capacity) : capacity_(capacity) {
+        long const pageSize = sysconf(_SC_PAGESIZE);
+        if ((capacity & (capacity - 1)) != 0 || capacity % pageSize != 0) {
+            throw std::invalid_argument("Capacity must be a power of 2 and a multiple of the page size");
+        }
+
+        int fd = memfd_create("spsc_byte_ring", MFD_CLOEXEC);
+        if (fd < 0) throw std::system_error(errno, std::generic_category(), "memfd_create");
+
+        if (ftruncate(fd, capacity) != 0) {
+            int error = errno;
+            close(fd);
+            throw std::system_error(error, std::generic_category(), "ftruncate");
+        }
+
+        void* base = mmap(nullptr, 2 * capacity, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (MAP_FAILED == base) {
+            int error = errno;
+            close(fd);
+            throw std::system_error(error, std::generic_category(), "mmap");
+        }
+
+        auto bytes = static_cast<std::byte*>(base);
+        for (std::byte* half : {bytes, bytes + capacity}) {
+            if (MAP_FAILED == mmap(half, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0)) {
+                int error = errno;
+                munmap(base, 2 * capacity);
+                close(fd);
+                throw std::system_error(error, std::generic_category(), "mmap");
+            }
+        }
+        close(fd);
+        data_ = bytes;
+    }
+
+    ~MirroredRingStorage() {
+        munmap(data_, 2 * capacity_);
+    }
+
+    MirroredRingStorage(MirroredRingStorage const&) = delete;
+    MirroredRingStorage& operator = (MirroredRingStorage const&) = delete;
+
+    std::byte* data() { return data_; }
+    std::size_t capacity() const { return capacity_; }
+
+private:
+    std::byte* data_;
+    std::size_t capacity_;
+};
+
+/*!
+ * Single producer, single consumer ring of variable-length records.
+ *
+ * The producer reserves a contiguous span, writes the record in place and
+ * commits it; the consumer reads it in place through a span and pops it.
+ * Nothing is allocated and nothing is copied besides the producer's write.
+ * head_/tail_ are byte positions that only grow; each side caches the other
+ * side's position and only reloads it when the cached value says full/empty.
+ */
+template <typename Storage>
+class SPSCByteRing {
+    static_assert(std::atomic<size_t>::is_always_lock_free);
+
+public:
+    template <typename... Args>
+    explicit SPSCByteRing(Args&&... args)
+        : storage_(std::forward<Args>(args)...), head_(0), cachedTail_(0), reserved_(0),
+          tail_(0), cachedHead_(0) {
+    }
+
+    std::size_t capacity() const { return storage_.capacity(); }
+
+    std::size_t maxRecordSize() const {
+        return (Storage::IsMirrored ? capacity() : capacity() / 2) - sizeof(RecordHeader);
+    }
+
+    /*!
+     * Reserve room for a record of up to @p length bytes, or nullopt if the
+     * ring is full right now; retrying after the consumer pops will succeed.
+     * The reservation only becomes visible on commit().
+     * Throws std::invalid_argument for @p type == PaddingType and for
+     * @p length > maxRecordSize(), which would never fit.
+     */
+    std::optional<std::span<std::byte>> reserve(uint32_t type, std::size_t length);
+
+    /*!
+     * Publish the reserved record, optionally shrunk to @p length bytes
+     * (never grown past the reservation). Does nothing without an
+     * outstanding reservation, e.g. after reserve() failed.
+     */
+    void commit(std::size_t length);
+    void commit() { commit(reservedLength_); }
+
+    bool push(uint32_t type, std::span<std::byte const> payload) {
+        auto record = reserve(type, payload.size());
+        if (!record) return false;
+        std::memcpy(record->data(), payload.data(), payload.size());
+        commit();
+        return true;
+    }
+
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    bool push(uint32_t type, T const& value) {
+        return push(type, std::span<std::byte const>(reinterpret_cast<std::byte const*>(&value), sizeof(T)));
+    }
+
+    /*!
+     * The oldest committed record, read in place. It stays valid until pop().
+     */
+    std::optional<RecordView> front();
+
+    /*!
+     * Drop the oldest record; does nothing on an empty ring.
+     */
+    void pop();
+
+private:
+    static constexpr std::size_t recordSize(std::size_t length) {
+        return (sizeof(RecordHeader) + length + RecordAlignment - 1) & ~(RecordAlignment - 1);
+    }
+
+    RecordHeader* headerAt(std::size_t position) {
+        return reinterpret_cast<RecordHeader*>(storage_.data() + (position & (capacity() - 1)));
+    }
+
+private:
+    Storage storage_;
+
+    // Producer side
+    alignas(hardware_destructive_interference_size) std::atomic<size_t> head_;
+    size_t cachedTail_;
+    size_t reserved_;           // position of the reserved record's header
+    size_t reservedLength_ = 0;
+    uint32_t reservedType_ = 0;
+    bool reservationOpen_ = false;
+
+    // Consumer side
+    alignas(hardware_destructive_interference_size) std::atomic<size_t> tail_;
+    size_t cachedHead_;
+};
+
+template <typename Storage>
+std::optional<std::span<std::byte>> SPSCByteRing<Storage>::reserve(uint32_t type, std::size_t length) {
+    if (type == PaddingType) throw std::invalid_argument("PaddingType is reserved for the ring");
+    reservationOpen_ = false;
+    if (length > maxRecordSize()) throw std::invalid_argument("Record does not fit in the ring");
+
+    size_t const needed = recordSize(length);
+    size_t head = head_.load(std::memory_order_relaxed);
+    size_t const offset = head & (capacity() - 1);
+    size_t padding = 0;
+
+    if (!Storage::IsMirrored && offset + needed > capacity()) {
+        padding = capacity() - offset;
+    }
+
+    if (head + padding + needed - cachedTail_ > capacity()) {
+        cachedTail_ = tail_.load(std::memory_order_acquire);
+        if (head + padding + needed - cachedTail_ > capacity()) return std::nullopt;
+    }
+
+    if (padding) {
+        // Published together with the record on commit.
+        *headerAt(head) = RecordHeader{static_cast<uint32_t>(padding - sizeof(RecordHeader)), PaddingType};
+        head += padding;
+    }
+
+    reserved_ = head;
+    reservedLength_ = length;
+    reservedType_ = type;
+    reservationOpen_ = true;
+    return std::span<std::byte>(reinterpret_cast<std::byte*>(headerAt(head) + 1), length);
+}
+
+template <typename Storage>
+void SPSCByteRing<Storage>::commit(std::size_t length) {
+    if (!reservationOpen_) return;
+    reservationOpen_ = false;
+    length = std::min(length, reservedLength_);
+    *headerAt(reserved_) = RecordHeader{static_cast<uint32_t>(length), reservedType_};
+    LOCK_FREE_CAS_POINT();
+    head_.store(reserved_ + recordSize(length), std::memory_order_release);
+}
+
+template <typename Storage>
+std::optional<RecordView> SPSCByteRing<Storage>::front() {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+
+    for (;;) {
+        if (tail == cachedHead_) {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            if (tail == cachedHead_) return std::nullopt;
+        }
+
+        RecordHeader const* header = headerAt(tail);
+        if (header->type != PaddingType) {
+            return RecordView{header->type,
+                              {reinterpret_cast<std::byte const*>(header + 1), header->length}};
+        }
+
+        tail += recordSize(header->length);
+        tail_.store(tail, std::memory_order_release);
+    }
+}
+
+template <typename Storage>
+void SPSCByteRing<Storage>::pop() {
+    // Skips padding and checks for a record, without re-reading head_ unless
+    // the cached copy says empty.
+    if (!front()) return;
+    size_t const tail = tail_.load(std::memory_order_relaxed);
+    RecordHeader const* header = headerAt(tail);
+    LOCK_FREE_CAS_POINT();
+    tail_.store(tail + recordSize(header->length), std::memory_order_release);
+}
+
+template <std::size_t Capacity>
+using SPSCInlineByteRing = SPSCByteRing<InlineRingStorage<Capacity>>;
+
+using SPSCMirroredByteRing = SPSCByteRing<MirroredRingStorage>;
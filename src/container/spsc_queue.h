@@ -1,8 +1,11 @@
 #pragma once
 #include <iostream>
+#include <array>
 #include <atomic>
 #include <new>
 
+#include "cas_point.h"
+
 #ifndef hardware_destructive_interference_size
 #define hardware_destructive_interference_size 64
 #endif
@@ -25,6 +28,7 @@ public:
         }
 
         buffer_[head] = value;
+        LOCK_FREE_CAS_POINT();
         head_.store(next_head, std::memory_order_release);
         return true;
     }
@@ -37,10 +41,16 @@ public:
         }
 
         value = buffer_[tail];
+        LOCK_FREE_CAS_POINT();
         tail_.store((tail + 1) & (Capacity - 1), std::memory_order_release);
         return true;
     }
 
+    // Consumer side only
+    bool empty() const {
+        return tail_.load(std::memory_order_relaxed) == head_.load(std::memory_order_acquire);
+    }
+
 private:
     alignas(hardware_destructive_interference_size) std::atomic<size_t> head_;
     char padding1_[hardware_destructive_interference_size - sizeof(size_t)]; // Padding to avoid false sharing
@@ -0,0 +1,92 @@
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "container/journal_queue.h"
+
+constexpr uint64_t RecordsPerWriter = 1000000;
+
+struct Result {
+    double seconds;
+    uint64_t records;
+    uint64_t bytes;
+};
+
+void print(std::string const& name, Result const& result) {
+    std::cout << std::left << std::setw(36) << name << std::fixed << std::setprecision(2)
+              << std::setw(10) << result.records / result.seconds / 1e6
+              << result.bytes / result.seconds / (1 << 20) << std::endl;
+}
+
+Result append(std::filesystem::path const& directory, JournalOptions const& options,
+              int writers, std::size_t recordSize) {
+    std::filesystem::remove_all(directory);
+    JournalQueue journal(directory, options);
+    std::vector<std::byte> payload(recordSize, std::byte{0x5a});
+
+    std::vector<std::thread> threads;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < writers; ++i) {
+        threads.emplace_back([&] {
+            for (uint64_t j = 0; j < RecordsPerWriter; ++j) journal.append(payload);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    auto end = std::chrono::high_resolution_clock::now();
+
+    uint64_t const records = writers * RecordsPerWriter;
+    return {std::chrono::duration<double>(end - start).count(), records, records * recordSize};
+}
+
+Result replay(std::filesystem::path const& directory) {
+    JournalReader reader(directory);
+    uint64_t records = 0, bytes = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    while (auto record = reader.next()) {
+        ++records;
+        bytes += record->size();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return {std::chrono::duration<double>(end - start).count(), records, bytes};
+}
+
+/*!
+ * Append throughput and replay speed of JournalQueue.
+ * Usage: journal_bench [directory...]; defaults to /dev/shm (tmpfs) and /tmp.
+ */
+int main(int argc, char** argv) {
+    std::vector<std::filesystem::path> roots;
+    for (int i = 1; i < argc; ++i) roots.emplace_back(argv[i]);
+    if (roots.empty()) roots = {"/dev/shm", std::filesystem::temp_directory_path()};
+
+    for (auto const& root : roots) {
+        std::filesystem::path const directory = root / "journal_bench";
+        std::cout << directory << std::endl;
+        std::cout << "run                                 Mrec/s    MiB/s" << std::endl;
+
+        for (std::size_t recordSize : {32, 256}) {
+            for (int writers : {1, 2, 4}) {
+                JournalOptions options;
+                std::string const name = "append " + std::to_string(recordSize) + "B x" + std::to_string(writers);
+                print(name, append(directory, options, writers, recordSize));
+            }
+        }
+
+        JournalOptions batched;
+        batched.syncMode = SyncMode::Async;
+        batched.syncEveryRecords = 4096;
+        print("append 256B x1, msync/4096", append(directory, batched, 1, 256));
+
+        batched.syncMode = SyncMode::Sync;
+        print("append 256B x1, fdatasync/4096", append(directory, batched, 1, 256));
+
+        print("replay", replay(directory));
+        std::filesystem::remove_all(directory);
+    }
+}
@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "container/lock_free_queue_hazard.h"
+
+constexpr int ItemsPerProducer = 100000;
+constexpr int Repeats = 5;
+
+std::atomic<uint64_t> totalRetries{0};
+
+/*!
+ * Wraps a backoff policy to count failed CAS attempts, i.e. retries.
+ */
+template <typename Backoff>
+struct CountingBackoff : Backoff {
+    static inline thread_local uint64_t retries = 0;
+
+    void operator()() {
+        ++retries;
+        Backoff::operator()();
+    }
+};
+
+template <typename Ordering, typename Backoff>
+using CountingPolicy = QueuePolicy<Ordering, CountingBackoff<Backoff>>;
+
+struct Result {
+    double mops;
+    double retriesPerOp;
+};
+
+template <typename Policy>
+Result runOnce(int threads) {
+    LockFreeQueue<int, Policy> queue;
+    std::atomic<int> totalPopped{0};
+    int const total = threads * ItemsPerProducer;
+    totalRetries.store(0);
+
+    auto flushRetries = [] {
+        totalRetries.fetch_add(Policy::backoff::retries);
+        Policy::backoff::retries = 0;
+    };
+
+    std::vector<std::thread> workers;
+    auto start = std::chrono::high_resolution_clock::now();
+
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back([&, i] {
+            for (int j = 0; j < ItemsPerProducer; ++j) {
+                queue.enqueue(i * ItemsPerProducer + j);
+            }
+            flushRetries();
+        });
+        workers.emplace_back([&] {
+            int value;
+            while (totalPopped.load(std::memory_order_relaxed) < total) {
+                if (queue.dequeue(value)) {
+                    totalPopped.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            flushRetries();
+        });
+    }
+
+    for (auto& worker : workers) worker.join();
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+    return Result{total / elapsed.count() / 1e6, double(totalRetries.load()) / (2.0 * total)};
+}
+
+/*!
+ * Median of Repeats runs; a single run on an oversubscribed host is mostly
+ * scheduler noise.
+ */
+template <typename Policy>
+void run(std::string const& name, int threads) {
+    std::vector<Result> results;
+    for (int i = 0; i < Repeats; ++i) results.push_back(runOnce<Policy>(threads));
+    std::sort(results.begin(), results.end(),
+              [](Result const& a, Result const& b) { return a.mops < b.mops; });
+    Result const median = results[Repeats / 2];
+
+    std::cout << std::left << std::setw(24) << name << std::setw(4) << threads
+              << std::fixed << std::setprecision(2) << std::setw(10) << median.mops
+              << std::setprecision(4) << median.retriesPerOp << std::endl;
+}
+
+int main() {
+    std::cout << "policy                  P=C Mops/s    retries/op (median of " << Repeats << ")" << std::endl;
+
+    for (int threads : {1, 2, 4, 8, 16, 32}) {
+        run<CountingPolicy<SeqCstOrdering, NoBackoff>>("seq_cst, no backoff", threads);
+        run<CountingPolicy<MinimalOrdering, NoBackoff>>("minimal, no backoff", threads);
+        run<CountingPolicy<MinimalOrdering, ExponentialBackoff<>>>("minimal, exponential", threads);
+    }
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include <boost/lockfree/queue.hpp>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "container/lock_free_queue.h"
+#include "container/lock_free_queue_hazard.h"
+#include "utils/perf_counters.h"
+
+constexpr int ItemsPerProducer = 200000;
+
+/*!
+ * Throughput of the MPMC queues under equal producer/consumer counts:
+ *  - LockFreeQueue:       hazard pointers, node + payload heap allocation per item
+ *  - TaggedLockFreeQueue: 128-bit tagged pointers, type-stable node pool
+ *  - boost::lockfree:     reference implementation (tagged freelist as well)
+ * Every worker counts its hardware events into @p perf, see perf_counters.h.
+ */
+template <typename Push, typename Pop>
+double run(int threads, PerfReport& perf, Push push, Pop pop) {
+    std::atomic<int> totalPopped{0};
+    int const total = threads * ItemsPerProducer;
+
+    std::vector<std::thread> workers;
+    auto start = std::chrono::high_resolution_clock::now();
+
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back([&, i] {
+            PerfScope scope(perf, "producer " + std::to_string(i));
+            for (int j = 0; j < ItemsPerProducer; ++j) {
+                push(i * ItemsPerProducer + j);
+            }
+            scope.operations(ItemsPerProducer);
+        });
+        workers.emplace_back([&, i] {
+            PerfScope scope(perf, "consumer " + std::to_string(i));
+            uint64_t popped = 0;
+            int value;
+            while (totalPopped.load(std::memory_order_relaxed) < total) {
+                if (pop(value)) {
+                    totalPopped.fetch_add(1, std::memory_order_relaxed);
+                    ++popped;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+            scope.operations(popped);
+        });
+    }
+
+    for (auto& worker : workers) worker.join();
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+    return total / elapsed.count() / 1e6;
+}
+
+/*!
+ * Throughput, then the counters per item (one push plus one pop).
+ */
+void report(std::string const& name, int threads, double mops, PerfReport const& perf) {
+    std::cout << std::left << std::setw(22) << name << std::setw(4) << threads
+              << std::fixed << std::setprecision(2) << mops << " Mops/s" << std::endl;
+    perf.print(std::cout, uint64_t(threads) * ItemsPerProducer);
+}
+
+int main() {
+    std::cout << "queue                 P=C  throughput" << std::endl;
+    PerfReport::printHeader(std::cout, 2);
+
+    for (int threads : {1, 2, 4, 8}) {
+        {
+            LockFreeQueue<int> queue;
+            PerfReport perf;
+            report("LockFreeQueue", threads, run(threads, perf,
+                [&](int value) { queue.enqueue(value); },
+                [&](int& value) { return queue.dequeue(value); }), perf);
+        }
+        {
+            TaggedLockFreeQueue<int> queue;
+            PerfReport perf;
+            report("TaggedLockFreeQueue", threads, run(threads, perf,
+                [&](int value) { queue.enqueue(value); },
+                [&](int& value) { return queue.dequeue(value); }), perf);
+        }
+        {
+            boost::lockfree::queue<int> queue(1024);
+            PerfReport perf;
+            report("boost::lockfree", threads, run(threads, perf,
+                [&](int value) { while (!queue.push(value)) {} },
+                [&](int& value) { return queue.pop(value); }), perf);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include <atomic>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "container/spsc_queue.h"
+#include "utils/numa.h"
+#include "utils/perf_counters.h"
+
+constexpr size_t QueueCapacity = 1024;
+constexpr int RoundTrips = 100000;
+
+using PingQueue = SPSCQueue<uint64_t, QueueCapacity>;
+
+/*!
+ * Ping-pong a counter between two threads through a pair of SPSC queues.
+ * Each queue lives on the node of the thread that consumes from it.
+ * Returns the average one-way latency in nanoseconds; the initiator's
+ * hardware counters go into @p perf.
+ */
+double measureOneWayLatency(std::optional<CpuPair> cpus, PerfReport& perf) {
+    CpuTopology const& topology = CpuTopology::instance();
+    int const pingNode = cpus ? topology.nodeOf(cpus->second) : 0;
+    int const pongNode = cpus ? topology.nodeOf(cpus->first) : 0;
+
+    PingQueue* ping = createOnNode<PingQueue>(pingNode);
+    PingQueue* pong = createOnNode<PingQueue>(pongNode);
+
+    std::atomic<bool> ready{false};
+
+    std::thread responder([&] {
+        if (cpus) pinThisThread(cpus->second);
+        ready.store(true, std::memory_order_release);
+        for (int i = 0; i < RoundTrips; ++i) {
+            uint64_t value;
+            while (!ping->pop(value)) {
+                std::this_thread::yield();
+            }
+            while (!pong->push(value + 1)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    if (cpus) pinThisThread(cpus->first);
+    while (!ready.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    {
+        PerfScope scope(perf, "initiator");
+        uint64_t value = 0;
+        for (int i = 0; i < RoundTrips; ++i) {
+            while (!ping->push(value)) {
+                std::this_thread::yield();
+            }
+            while (!pong->pop(value)) {
+                std::this_thread::yield();
+            }
+        }
+        scope.operations(RoundTrips);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    responder.join();
+    destroyOnNode(ping);
+    destroyOnNode(pong);
+
+    std::chrono::duration<double, std::nano> elapsed = end - start;
+    return elapsed.count() / (2.0 * RoundTrips);
+}
+
+void report(std::string const& name, std::optional<CpuPair> cpus) {
+    std::cout << name << ": ";
+    if (!cpus) {
+        std::cout << "n/a on this host" << std::endl;
+        return;
+    }
+    PerfReport perf;
+    double latency = measureOneWayLatency(cpus, perf);
+    std::cout << "cpu " << cpus->first << " <-> cpu " << cpus->second
+              << ", " << latency << " ns one-way" << std::endl;
+    perf.print(std::cout, RoundTrips);
+}
+
+int main() {
+    CpuTopology const& topology = CpuTopology::instance();
+    std::cout << "CPUs: " << topology.cpus().size()
+              << ", NUMA nodes: " << topology.nodeCount()
+              << ", libnuma: " << (isNumaAvailable() ? "yes" : "no") << std::endl;
+    PerfReport::printHeader(std::cout, 2);
+
+    report("same-core-pair", topology.sameCorePair());
+    report("same-socket", topology.sameSocketPair());
+    report("cross-node (same socket)", topology.crossNodePair());
+    report("cross-socket", topology.crossSocketPair());
+
+    PerfReport perf;
+    std::cout << "unpinned: " << measureOneWayLatency(std::nullopt, perf) << " ns one-way" << std::endl;
+    perf.print(std::cout, RoundTrips);
+    return 0;
+}
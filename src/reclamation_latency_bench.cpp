@@ -0,0 +1,73 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "container/lock_free_queue_hazard.h"
+
+constexpr int ItemsPerProducer = 200000;
+
+using Clock = std::chrono::steady_clock;
+
+/*!
+ * Consumer-side dequeue latency with inline vs. deferred reclamation.
+ * Every successful dequeue is timed; the percentiles are over all of them.
+ */
+template <typename Policy>
+void run(std::string const& name, int threads) {
+    LockFreeQueue<int, Policy> queue;
+    std::atomic<int> totalPopped{0};
+    int const total = threads * ItemsPerProducer;
+    std::vector<std::vector<uint32_t>> latencies(threads);
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back([&, i] {
+            for (int j = 0; j < ItemsPerProducer; ++j) {
+                queue.enqueue(i * ItemsPerProducer + j);
+            }
+        });
+        workers.emplace_back([&, i] {
+            auto& samples = latencies[i];
+            samples.reserve(total);
+            int value;
+            while (totalPopped.load(std::memory_order_relaxed) < total) {
+                auto start = Clock::now();
+                bool const popped = queue.dequeue(value);
+                auto end = Clock::now();
+                if (popped) {
+                    samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+                    totalPopped.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+
+    std::vector<uint32_t> all;
+    for (auto const& samples : latencies) all.insert(all.end(), samples.begin(), samples.end());
+    std::sort(all.begin(), all.end());
+    auto percentile = [&](double p) { return all[static_cast<std::size_t>(p * (all.size() - 1))]; };
+
+    std::cout << std::left << std::setw(24) << name << std::setw(4) << threads
+              << std::setw(8) << percentile(0.5) << std::setw(8) << percentile(0.99)
+              << std::setw(10) << percentile(0.999) << all.back() << std::endl;
+}
+
+int main() {
+    using Inline = QueuePolicy<MinimalOrdering, NoBackoff, InlineReclamation>;
+    using Deferred = QueuePolicy<MinimalOrdering, NoBackoff, DeferredReclamation>;
+
+    std::cout << "dequeue latency (ns)    P=C p50     p99     p99.9     max" << std::endl;
+
+    ReclaimerThread<int> reclaimer;
+    for (int threads : {1, 2, 4, 8}) {
+        run<Inline>("inline reclamation", threads);
+        run<Deferred>("deferred reclamation", threads);
+    }
+}
@@ -0,0 +1,296 @@
+#pragma once
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef HAVE_LIBNUMA
+#include <numa.h>
+#endif
+
+/*!
+ * NUMA helpers for cross-socket pipelines.
+ *
+ * The queues themselves stay placement agnostic: SPSCQueue keeps its ring
+ * inline, so constructing the queue object on a node places the ring there.
+ * TaggedLockFreeQueue takes its node pool from an allocator; NodeAllocator
+ * binds the pool to a node. LockFreeQueue allocates nodes with plain new from
+ * the enqueuing thread: preferNodeForThisThread() only steers pages the
+ * allocator maps afterwards, memory malloc already holds stays where it is.
+ * Without libnuma (or on a single node host) everything falls back to plain
+ * first-touch allocation on node 0.
+ */
+
+struct CpuInfo {
+    int cpu;
+    int node;
+    int package;
+    int core;
+    int l3;
+};
+
+using CpuPair = std::pair<int, int>;
+
+/*!
+ * Parse a sysfs cpu list such as "0-3,8,10-11".
+ */
+inline std::vector<int> parseCpuList(std::string const& list) {
+    std::vector<int> cpus;
+    std::size_t pos = 0;
+    while (pos < list.size()) {
+        std::size_t end = list.find(',', pos);
+        if (end == std::string::npos) end = list.size();
+        std::string range = list.substr(pos, end - pos);
+        pos = end + 1;
+
+        while (!range.empty() && std::isspace(static_cast<unsigned char>(range.back()))) range.pop_back();
+        if (range.empty()) continue;
+
+        std::size_t dash = range.find('-');
+        int first = std::atoi(range.substr(0, dash).c_str());
+        int last = dash == std::string::npos ? first : std::atoi(range.substr(dash + 1).c_str());
+        for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+class CpuTopology {
+public:
+    /*!
+     * Discover the topology below a sysfs root. Tests point this to a fake
+     * tree to emulate multi-socket hosts.
+     */
+    static CpuTopology fromSysfs(std::string const& root = "/sys/devices/system") {
+        CpuTopology topology;
+        std::vector<int> online = parseCpuList(readLine(root + "/cpu/online"));
+        if (online.empty()) online.push_back(0);
+
+        for (int cpu : online) {
+            std::string const base = root + "/cpu/cpu" + std::to_string(cpu);
+            CpuInfo info{cpu, 0, readInt(base + "/topology/physical_package_id", 0),
+                         readInt(base + "/topology/core_id", cpu), -1};
+
+            std::vector<int> l3 = parseCpuList(readLine(base + "/cache/index3/shared_cpu_list"));
+            info.l3 = l3.empty() ? info.package : l3.front();
+            topology.cpus_.push_back(info);
+        }
+
+        // Node ids may be sparse (memory-only or CXL nodes), so take them from
+        // the online list rather than counting up until nodeN is missing.
+        topology.nodes_ = parseCpuList(readLine(root + "/node/online"));
+        if (topology.nodes_.empty()) topology.nodes_.push_back(0);
+        for (int node : topology.nodes_) {
+            std::string const cpulist = root + "/node/node" + std::to_string(node) + "/cpulist";
+            for (int cpu : parseCpuList(readLine(cpulist))) {
+                if (CpuInfo* info = topology.find(cpu)) info->node = node;
+            }
+        }
+        return topology;
+    }
+
+    static CpuTopology const& instance() {
+        static CpuTopology const topology = fromSysfs();
+        return topology;
+    }
+
+    std::vector<CpuInfo> const& cpus() const { return cpus_; }
+
+    int nodeOf(int cpu) const {
+        CpuInfo const* info = find(cpu);
+        return info ? info->node : 0;
+    }
+
+    /*! Online node ids, including nodes without CPUs. */
+    std::vector<int> const& nodes() const { return nodes_; }
+
+    int nodeCount() const { return static_cast<int>(nodes_.size()); }
+
+    /*! Two hardware threads of the same physical core. */
+    std::optional<CpuPair> sameCorePair() const {
+        return findPair([](CpuInfo const& a, CpuInfo const& b) {
+            return a.package == b.package && a.core == b.core;
+        });
+    }
+
+    /*! Two distinct cores sharing an L3, i.e. the pinning a pipeline wants. */
+    std::optional<CpuPair> sameSocketPair() const {
+        return findPair([](CpuInfo const& a, CpuInfo const& b) {
+            return a.l3 == b.l3 && a.core != b.core;
+        });
+    }
+
+    /*! Two CPUs in different packages. */
+    std::optional<CpuPair> crossSocketPair() const {
+        return findPair([](CpuInfo const& a, CpuInfo const& b) {
+            return a.package != b.package;
+        });
+    }
+
+    /*! Two CPUs of one package on different nodes (sub-NUMA clustering). */
+    std::optional<CpuPair> crossNodePair() const {
+        return findPair([](CpuInfo const& a, CpuInfo const& b) {
+            return a.package == b.package && a.node != b.node;
+        });
+    }
+
+private:
+    CpuInfo* find(int cpu) {
+        for (auto& info : cpus_) if (info.cpu == cpu) return &info;
+        return nullptr;
+    }
+
+    CpuInfo const* find(int cpu) const {
+        return const_cast<CpuTopology*>(this)->find(cpu);
+    }
+
+    template <typename Predicate>
+    std::optional<CpuPair> findPair(Predicate predicate) const {
+        for (std::size_t i = 0; i < cpus_.size(); ++i) {
+            for (std::size_t j = i + 1; j < cpus_.size(); ++j) {
+                if (predicate(cpus_[i], cpus_[j])) return CpuPair{cpus_[i].cpu, cpus_[j].cpu};
+            }
+        }
+        return std::nullopt;
+    }
+
+    static std::string readLine(std::string const& path) {
+        std::ifstream file(path);
+        std::string line;
+        std::getline(file, line);
+        return line;
+    }
+
+    static int readInt(std::string const& path, int fallback) {
+        std::string const line = readLine(path);
+        return line.empty() ? fallback : std::atoi(line.c_str());
+    }
+
+private:
+    std::vector<CpuInfo> cpus_;
+    std::vector<int> nodes_;
+};
+
+inline bool pinThisThread(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return 0 == pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+inline bool isNumaAvailable() {
+#ifdef HAVE_LIBNUMA
+    return numa_available() != -1;
+#else
+    return false;
+#endif
+}
+
+/*!
+ * Prefer @p node for the pages the calling thread faults in from now on.
+ * Memory malloc already holds is not moved; use NodeAllocator for placement
+ * that must hold.
+ */
+inline bool preferNodeForThisThread(int node) {
+#ifdef HAVE_LIBNUMA
+    if (!isNumaAvailable()) return false;
+    numa_set_preferred(node);
+    return true;
+#else
+    (void)node;
+    return false;
+#endif
+}
+
+/*!
+ * Page aligned allocation bound to @p node; plain anonymous mapping otherwise.
+ */
+inline void* allocateOnNode(std::size_t bytes, int node) {
+#ifdef HAVE_LIBNUMA
+    if (isNumaAvailable() && node <= numa_max_node()) {
+        void* memory = numa_alloc_onnode(bytes, node);
+        if (nullptr == memory) throw std::bad_alloc();
+        return memory;
+    }
+#else
+    (void)node;
+#endif
+    void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (MAP_FAILED == memory) throw std::bad_alloc();
+    return memory;
+}
+
+inline void deallocateOnNode(void* memory, std::size_t bytes) {
+#ifdef HAVE_LIBNUMA
+    if (isNumaAvailable()) {
+        numa_free(memory, bytes);
+        return;
+    }
+#endif
+    munmap(memory, bytes);
+}
+
+/*!
+ * Construct a queue (or anything else) in memory bound to @p node. The pages
+ * are first touched by the constructor, after the binding is in place.
+ */
+template <typename T, typename... Args>
+T* createOnNode(int node, Args&&... args) {
+    static_assert(alignof(T) <= 4096, "Page alignment is all allocateOnNode guarantees");
+    void* memory = allocateOnNode(sizeof(T), node);
+    try {
+        return new (memory) T(std::forward<Args>(args)...);
+    } catch (...) {
+        deallocateOnNode(memory, sizeof(T));
+        throw;
+    }
+}
+
+template <typename T>
+void destroyOnNode(T* object) {
+    if (nullptr == object) return;
+    object->~T();
+    deallocateOnNode(object, sizeof(T));
+}
+
+/*!
+ * Allocator for memory bound to one node, e.g. TaggedLockFreeQueue's pool:
+ *   TaggedLockFreeQueue<int, NodeAllocator<int>> queue(capacity, NodeAllocator<int>(node));
+ * Every allocation is at least a page, so use it for bulk storage only.
+ */
+template <typename T>
+class NodeAllocator {
+public:
+    using value_type = T;
+
+    explicit NodeAllocator(int node) : node_(node) {}
+
+    template <typename U>
+    NodeAllocator(NodeAllocator<U> const& other) : node_(other.node()) {}
+
+    T* allocate(std::size_t count) {
+        static_assert(alignof(T) <= 4096, "Page alignment is all allocateOnNode guarantees");
+        return static_cast<T*>(allocateOnNode(count * sizeof(T), node_));
+    }
+
+    void deallocate(T* memory, std::size_t count) {
+        deallocateOnNode(memory, count * sizeof(T));
+    }
+
+    int node() const { return node_; }
+
+    template <typename U>
+    bool operator == (NodeAllocator<U> const& other) const { return node_ == other.node(); }
+
+private:
+    int node_;
+};
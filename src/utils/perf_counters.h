@@ -0,0 +1,373 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/*!
+ * Hardware performance counters for the benchmarks, through perf_event_open.
+ *
+ * A PerfScope counts what the calling thread does between its construction
+ * and destruction, user space only, and adds it to a PerfReport. The report
+ * keeps one row per scope plus the total, normalized per operation.
+ *
+ * Every event is opened on its own, so a PMU that lacks one (e.g. no
+ * remote-HITM event, or no PMU at all in a VM) only blanks that column.
+ * When perf is not permitted at all (perf_event_paranoid, seccomp) the
+ * scopes do nothing and the report says why.
+ *
+ *   PERF_COUNTERS=0          disable counting
+ *   PERF_HITM_EVENT=0x04d3   raw config of the HITM event. Without it the
+ *                            column is only counted on the Intel server
+ *                            models where 0x04d3 is
+ *                            MEM_LOAD_L3_MISS_RETIRED.REMOTE_HITM, and blank
+ *                            elsewhere
+ *   PERF_PER_THREAD=1        print a row per thread, not only the total
+ */
+
+enum class PerfEvent {
+    Cycles,
+    Instructions,
+    BranchMisses,
+    L1DMisses,
+    LLCMisses,
+    RemoteHitm,
+    Count,
+};
+
+constexpr std::size_t PerfEventCount = static_cast<std::size_t>(PerfEvent::Count);
+
+using PerfValues = std::array<std::optional<uint64_t>, PerfEventCount>;
+
+inline char const* perfEventName(PerfEvent event) {
+    switch (event) {
+    case PerfEvent::Cycles:       return "cycles";
+    case PerfEvent::Instructions: return "instr";
+    case PerfEvent::BranchMisses: return "br-miss";
+    case PerfEvent::L1DMisses:    return "L1D-miss";
+    case PerfEvent::LLCMisses:    return "LLC-miss";
+    case PerfEvent::RemoteHitm:   return "HITM";
+    default:                      return "?";
+    }
+}
+
+inline bool perfCountersEnabled() {
+    char const* value = std::getenv("PERF_COUNTERS");
+    return nullptr == value || std::string(value) != "0";
+}
+
+/*!
+ * Raw config of the remote HITM event for the first CPU in @p cpuinfo (the
+ * format of /proc/cpuinfo), or nullopt where we do not know it. Raw events
+ * are model specific: the same code counts something else, or nothing, on
+ * client parts and on other generations.
+ */
+inline std::optional<uint64_t> perfHitmConfig(std::istream& cpuinfo) {
+    std::string vendor;
+    int family = -1;
+    int model = -1;
+    std::string line;
+    while (std::getline(cpuinfo, line) && !line.empty()) {
+        std::size_t const colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        std::string key = line.substr(0, colon);
+        key.erase(key.find_last_not_of(" \t") + 1);
+        std::string const value = line.substr(colon + 1);
+        if (key == "vendor_id") vendor = value;
+        else if (key == "cpu family") family = std::atoi(value.c_str());
+        else if (key == "model") model = std::atoi(value.c_str());
+    }
+    if (vendor.find("GenuineIntel") == std::string::npos || family != 6) return std::nullopt;
+
+    switch (model) {
+    case 0x55:              // Skylake-SP, Cascade Lake-SP, Cooper Lake
+    case 0x6a: case 0x6c:   // Ice Lake-SP
+    case 0x8f:              // Sapphire Rapids
+    case 0xcf:              // Emerald Rapids
+        return 0x04d3;      // MEM_LOAD_L3_MISS_RETIRED.REMOTE_HITM
+    default:
+        return std::nullopt;
+    }
+}
+
+/*!
+ * PERF_HITM_EVENT if set, else the known event for this CPU.
+ */
+inline std::optional<uint64_t> perfHitmConfig() {
+    if (char const* value = std::getenv("PERF_HITM_EVENT")) {
+        return std::strtoull(value, nullptr, 0);
+    }
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    return perfHitmConfig(cpuinfo);
+}
+
+inline std::optional<perf_event_attr> perfEventAttr(PerfEvent event) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    attr.type = PERF_TYPE_HARDWARE;
+    switch (event) {
+    case PerfEvent::Cycles:       attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+    case PerfEvent::Instructions: attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+    case PerfEvent::BranchMisses: attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+    case PerfEvent::LLCMisses:    attr.config = PERF_COUNT_HW_CACHE_MISSES; break;
+    case PerfEvent::L1DMisses:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_L1D |
+                      PERF_COUNT_HW_CACHE_OP_READ << 8 |
+                      PERF_COUNT_HW_CACHE_RESULT_MISS << 16;
+        break;
+    case PerfEvent::RemoteHitm: {
+        static std::optional<uint64_t> const config = perfHitmConfig();
+        if (!config) return std::nullopt;
+        attr.type = PERF_TYPE_RAW;
+        attr.config = *config;
+        break;
+    }
+    default:
+        return std::nullopt;
+    }
+    return attr;
+}
+
+/*!
+ * The counters of the calling thread. Opening and reading cost syscalls, so
+ * keep them outside the measured loop.
+ */
+class PerfCounters {
+public:
+    PerfCounters() {
+        fds_.fill(-1);
+        if (!perfCountersEnabled()) {
+            error_ = "disabled by PERF_COUNTERS=0";
+            return;
+        }
+
+        for (std::size_t i = 0; i < PerfEventCount; ++i) {
+            auto attr = perfEventAttr(static_cast<PerfEvent>(i));
+            if (!attr) continue;
+            fds_[i] = static_cast<int>(syscall(SYS_perf_event_open, &*attr, 0, -1, -1, 0));
+            if (fds_[i] < 0 && error_.empty()) error_ = std::strerror(errno);
+        }
+    }
+
+    ~PerfCounters() {
+        for (int fd : fds_) if (fd >= 0) close(fd);
+    }
+
+    PerfCounters(PerfCounters const&) = delete;
+    PerfCounters& operator = (PerfCounters const&) = delete;
+
+    bool available() const {
+        for (int fd : fds_) if (fd >= 0) return true;
+        return false;
+    }
+
+    /*!
+     * Why the first event that failed could not be opened.
+     */
+    std::string const& error() const { return error_; }
+
+    void start() {
+        for (int fd : fds_) {
+            if (fd < 0) continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    void stop() {
+        for (int fd : fds_) if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    }
+
+    /*!
+     * Counts since start(), scaled up if the kernel multiplexed the event.
+     */
+    PerfValues read() const {
+        PerfValues values;
+        for (std::size_t i = 0; i < PerfEventCount; ++i) {
+            uint64_t data[3];   // value, time enabled, time running
+            if (fds_[i] < 0 || ::read(fds_[i], data, sizeof(data)) != sizeof(data)) continue;
+            if (0 == data[2]) continue;     // never scheduled on the PMU
+            values[i] = data[2] == data[1] ? data[0]
+                                           : static_cast<uint64_t>(double(data[0]) * data[1] / data[2]);
+        }
+        return values;
+    }
+
+private:
+    std::array<int, PerfEventCount> fds_;
+    std::string error_;
+};
+
+/*!
+ * Counter totals of one benchmark run.
+ */
+class PerfReport {
+public:
+    struct Row {
+        std::string label;
+        PerfValues values;
+        uint64_t operations;
+    };
+
+    void add(std::string label, PerfValues const& values, uint64_t operations) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        rows_.push_back(Row{std::move(label), values, operations});
+    }
+
+    void unavailable(std::string const& error) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (error_.empty()) error_ = error;
+    }
+
+    /*!
+     * Sum over the rows; an event is only reported if every row has it, so
+     * a thread whose counters failed to open blanks the total rather than
+     * making it look cheaper.
+     */
+    Row total(uint64_t operations) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Row total{"total", {}, operations};
+        for (std::size_t i = 0; i < PerfEventCount; ++i) {
+            uint64_t sum = 0;
+            bool complete = !rows_.empty();
+            for (auto const& row : rows_) {
+                if (!row.values[i]) complete = false;
+                else sum += *row.values[i];
+            }
+            if (complete) total.values[i] = sum;
+        }
+        return total;
+    }
+
+    static void printHeader(std::ostream& out, int indent) {
+        out << std::string(indent, ' ') << std::left << std::setw(14) << "per op";
+        for (std::size_t i = 0; i < PerfEventCount; ++i) {
+            out << std::setw(10) << perfEventName(static_cast<PerfEvent>(i));
+        }
+        out << "IPC" << std::endl;
+    }
+
+    /*!
+     * One line per op-normalized row: the total over @p operations, and each
+     * scope's own row when PERF_PER_THREAD=1.
+     */
+    void print(std::ostream& out, uint64_t operations, int indent = 2) const {
+        std::vector<Row> rows;
+        std::string error;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            rows = rows_;
+            error = error_;
+        }
+
+        auto const counted = [](Row const& row) {
+            for (auto const& value : row.values) if (value) return true;
+            return false;
+        };
+        std::size_t const missing = std::count_if(rows.begin(), rows.end(),
+                                                  [&](Row const& row) { return !counted(row); });
+
+        if (missing == rows.size()) {
+            out << std::string(indent, ' ') << "perf counters unavailable: "
+                << (error.empty() ? "no scope ran" : error)
+                << " (perf_event_paranoid=" << paranoid() << ")" << std::endl;
+            return;
+        }
+        if (missing > 0) {
+            out << std::string(indent, ' ') << "partial: no counters for " << missing << " of "
+                << rows.size() << " threads: " << error << std::endl;
+        }
+
+        char const* perThread = std::getenv("PERF_PER_THREAD");
+        if (perThread && std::string(perThread) == "1") {
+            for (auto const& row : rows) printRow(out, row, indent);
+        }
+        printRow(out, total(operations), indent);
+    }
+
+private:
+    static void printRow(std::ostream& out, Row const& row, int indent) {
+        double const operations = row.operations ? double(row.operations) : 1.0;
+        out << std::string(indent, ' ') << std::left << std::setw(14) << row.label
+            << std::fixed << std::setprecision(2);
+        for (auto const& value : row.values) {
+            if (value) out << std::setw(10) << *value / operations;
+            else out << std::setw(10) << "n/a";
+        }
+
+        auto const& cycles = row.values[static_cast<std::size_t>(PerfEvent::Cycles)];
+        auto const& instructions = row.values[static_cast<std::size_t>(PerfEvent::Instructions)];
+        if (cycles && instructions && *cycles) out << double(*instructions) / *cycles;
+        else out << "n/a";
+        out << std::endl;
+    }
+
+    static std::string paranoid() {
+        std::ifstream file("/proc/sys/kernel/perf_event_paranoid");
+        std::string value;
+        std::getline(file, value);
+        return value.empty() ? "?" : value;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<Row> rows_;
+    std::string error_;
+};
+
+/*!
+ * Counts the calling thread from construction to destruction into @p report.
+ * Set operations() to the work done in the scope to get a per-op row.
+ */
+class PerfScope {
+public:
+    PerfScope(PerfReport& report, std::string label) : report_(report), label_(std::move(label)) {
+        if (counters_.available()) counters_.start();
+        else report_.unavailable(counters_.error());
+    }
+
+    /*!
+     * A scope without counters still adds its (empty) row, so the total
+     * knows it is incomplete.
+     */
+    ~PerfScope() {
+        if (!counters_.available()) {
+            report_.add(std::move(label_), PerfValues{}, operations_);
+            return;
+        }
+        counters_.stop();
+        report_.add(std::move(label_), counters_.read(), operations_);
+    }
+
+    PerfScope(PerfScope const&) = delete;
+    PerfScope& operator = (PerfScope const&) = delete;
+
+    void operations(uint64_t count) { operations_ = count; }
+
+private:
+    PerfReport& report_;
+    std::string label_;
+    PerfCounters counters_;
+    uint64_t operations_ = 0;
+};
@@ -0,0 +1,222 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*!
+ * Randomized stress harness for the lock-free containers.
+ *
+ * Every value carries its producer id and a per-producer sequence number, so
+ * the consumers can check that
+ *  - each value is delivered exactly once (no loss, no duplication),
+ *  - values of one producer are seen in increasing order by every consumer
+ *    (per-producer FIFO, which any linearizable FIFO queue guarantees).
+ * A lost value would otherwise keep the consumers waiting forever: once every
+ * producer is done, a consumer that fails QuiescentPops pops in a row declares
+ * the container drained, and the missing values are reported.
+ *
+ * Sizes come from the environment so CI runs stay short while a local run can
+ * push millions of operations through a container:
+ *   STRESS_OPERATIONS=5000000 STRESS_SEED=42 ./lock_free_stress_gtest
+ */
+
+struct StressConfig {
+    std::size_t operations;     // values produced in total
+    int producers;              // threads that only enqueue
+    int consumers;              // threads that only dequeue
+    int mixed;                  // threads that randomly do both
+    unsigned seed;
+};
+
+struct StressReport {
+    bool ok = true;
+    std::string error;
+    std::size_t operations = 0; // enqueues + dequeues
+    double seconds = 0;
+
+    double throughput() const { return seconds > 0 ? operations / seconds : 0; }
+};
+
+inline std::size_t stressEnv(char const* name, std::size_t fallback) {
+    char const* value = std::getenv(name);
+    return value ? std::strtoull(value, nullptr, 10) : fallback;
+}
+
+inline StressConfig makeStressConfig(int producers, int consumers, int mixed = 0) {
+    return StressConfig{
+        stressEnv("STRESS_OPERATIONS", 100000),
+        producers,
+        consumers,
+        mixed,
+        static_cast<unsigned>(stressEnv("STRESS_SEED", std::random_device{}())),
+    };
+}
+
+template <typename Push, typename Pop>
+class StressRun {
+public:
+    StressRun(StressConfig const& config, Push push, Pop pop)
+        : config_(config), push_(push), pop_(pop) {
+        int const writers = config_.producers + config_.mixed;
+        perProducer_ = config_.operations / writers;
+        total_ = perProducer_ * writers;
+        seen_ = std::make_unique<std::atomic<uint8_t>[]>(total_);
+        for (std::size_t i = 0; i < total_; ++i) seen_[i].store(0, std::memory_order_relaxed);
+    }
+
+    StressReport run() {
+        std::vector<std::thread> threads;
+        int producerId = 0;
+        int threadId = 0;
+        auto start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < config_.producers; ++i) {
+            threads.emplace_back([this, id = producerId++, seed = threadSeed(threadId++)] {
+                worker(id, seed, false);
+            });
+        }
+        for (int i = 0; i < config_.mixed; ++i) {
+            threads.emplace_back([this, id = producerId++, seed = threadSeed(threadId++)] {
+                worker(id, seed, true);
+            });
+        }
+        for (int i = 0; i < config_.consumers; ++i) {
+            threads.emplace_back([this, seed = threadSeed(threadId++)] {
+                worker(-1, seed, true);
+            });
+        }
+        for (auto& thread : threads) thread.join();
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        for (std::size_t i = 0; i < total_ && !failed_.load(); ++i) {
+            if (seen_[i].load(std::memory_order_relaxed) != 1) {
+                fail("value " + std::to_string(i) + " seen " +
+                     std::to_string(seen_[i].load()) + " times" +
+                     (drained_.load() ? ", " + std::to_string(total_ - consumed_.load()) +
+                                        " values lost" : std::string()));
+            }
+        }
+
+        report_.operations = 2 * consumed_.load();
+        report_.seconds = elapsed.count();
+        return report_;
+    }
+
+private:
+    static constexpr int SequenceBits = 40;
+    static constexpr unsigned QuiescentPops = 100000;
+
+    int writers() const { return config_.producers + config_.mixed; }
+
+    unsigned threadSeed(int threadId) const { return config_.seed * 7919u + threadId; }
+
+    void fail(std::string const& error) {
+        std::lock_guard<std::mutex> lock(errorMutex_);
+        if (!failed_.exchange(true)) {
+            report_.ok = false;
+            report_.error = error + " (STRESS_SEED=" + std::to_string(config_.seed) + ")";
+        }
+    }
+
+    bool finished() const {
+        return failed_.load(std::memory_order_relaxed) ||
+               drained_.load(std::memory_order_relaxed) ||
+               consumed_.load(std::memory_order_relaxed) >= total_;
+    }
+
+    /*!
+     * Producer id < 0 means a pure consumer. Bursts, op choice and pauses are
+     * all drawn at random so every run exercises a different schedule.
+     */
+    void worker(int producerId, unsigned seed, bool consumes) {
+        std::minstd_rand random(seed);
+        std::vector<uint64_t> lastSequence(config_.producers + config_.mixed, 0);
+        std::size_t produced = producerId < 0 ? perProducer_ : 0;
+        unsigned failedPops = 0;
+
+        while (!finished() && (consumes || produced < perProducer_)) {
+            bool const produce = produced < perProducer_ && (!consumes || random() % 2);
+            unsigned const burst = 1 + random() % 32;
+
+            for (unsigned i = 0; i < burst && !finished(); ++i) {
+                if (produce) {
+                    if (produced == perProducer_) break;
+                    uint64_t value = (static_cast<uint64_t>(producerId) << SequenceBits) | produced;
+                    if (!push_(value)) continue;
+                    if (++produced == perProducer_) writersDone_.fetch_add(1);
+                } else {
+                    uint64_t value;
+                    if (!pop_(value)) {
+                        // Every push has returned and still nothing comes out.
+                        if (writersDone_.load() == writers() && ++failedPops >= QuiescentPops) {
+                            drained_.store(true);
+                        }
+                        break;
+                    }
+                    failedPops = 0;
+                    check(lastSequence, value);
+                }
+            }
+
+            if (random() % 16 == 0) std::this_thread::yield();
+        }
+    }
+
+    void check(std::vector<uint64_t>& lastSequence, uint64_t value) {
+        uint64_t const producer = value >> SequenceBits;
+        uint64_t const sequence = value & ((uint64_t(1) << SequenceBits) - 1);
+
+        if (producer >= lastSequence.size() || sequence >= perProducer_) {
+            fail("corrupted value " + std::to_string(value));
+            return;
+        }
+
+        // Sequence numbers are stored + 1 so that 0 means "nothing seen yet".
+        if (sequence + 1 <= lastSequence[producer]) {
+            fail("producer " + std::to_string(producer) + " out of order: " +
+                 std::to_string(sequence) + " after " + std::to_string(lastSequence[producer] - 1));
+        }
+        lastSequence[producer] = sequence + 1;
+
+        if (seen_[producer * perProducer_ + sequence].fetch_add(1, std::memory_order_relaxed) != 0) {
+            fail("duplicate value " + std::to_string(value));
+        }
+        consumed_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+private:
+    StressConfig config_;
+    Push push_;
+    Pop pop_;
+
+    std::size_t perProducer_;
+    std::size_t total_;
+    std::unique_ptr<std::atomic<uint8_t>[]> seen_;
+    std::atomic<std::size_t> consumed_{0};
+    std::atomic<int> writersDone_{0};
+    std::atomic<bool> drained_{false};
+
+    std::mutex errorMutex_;
+    std::atomic<bool> failed_{false};
+    StressReport report_;
+};
+
+template <typename Push, typename Pop>
+StressReport runStress(StressConfig const& config, Push push, Pop pop) {
+    return StressRun<Push, Pop>(config, push, pop).run();
+}
+
+inline void printStressReport(std::string const& name, StressReport const& report) {
+    std::cout << "[ STRESS   ] " << name << ": " << report.operations << " ops in "
+              << report.seconds << " s, " << static_cast<std::size_t>(report.throughput())
+              << " ops/s" << std::endl;
+}
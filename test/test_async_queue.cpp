@@ -0,0 +1,192 @@
+#include <container/async_queue.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+template <typename Queue>
+DetachedTask consume(Queue& queue, std::vector<int>& seen, std::atomic<int>& done) {
+    int value = co_await queue.pop();
+    seen[value] += 1;
+    done.fetch_add(1);
+}
+
+template <typename Queue>
+DetachedTask consumeAll(Queue& queue, int count, std::vector<int>& received, std::atomic<bool>& done) {
+    for (int i = 0; i < count; ++i) {
+        received.push_back(co_await queue.pop());
+    }
+    done.store(true);
+}
+
+}
+
+TEST(AsyncQueue, singleThreadedExecutor) {
+    constexpr int consumers = 1000;
+    ManualExecutor executor;
+    AsyncQueue<int, ManualExecutor> queue(executor);
+
+    std::vector<int> seen(consumers, 0);
+    std::atomic<int> done{0};
+
+    for (int i = 0; i < consumers; ++i) {
+        spawn(executor, consume(queue, seen, done));
+    }
+    // Every consumer runs up to its co_await and suspends on the empty queue.
+    EXPECT_EQ(executor.run(), consumers);
+    EXPECT_EQ(done.load(), 0);
+
+    for (int i = 0; i < consumers; ++i) {
+        queue.push(i);
+    }
+    // Each push scheduled exactly one waiter.
+    EXPECT_EQ(executor.run(), consumers);
+    EXPECT_EQ(done.load(), consumers);
+    for (int count : seen) {
+        EXPECT_EQ(count, 1);
+    }
+}
+
+TEST(AsyncQueue, readyValueDoesNotSuspend) {
+    ManualExecutor executor;
+    AsyncQueue<int, ManualExecutor, TaggedLockFreeQueue<int>> queue(executor);
+    std::vector<int> received;
+    std::atomic<bool> done{false};
+
+    queue.push(1);
+    queue.push(2);
+    spawn(executor, consumeAll(queue, 2, received, done));
+
+    EXPECT_EQ(executor.run(), 1);
+    EXPECT_TRUE(done.load());
+    EXPECT_EQ(received, (std::vector<int>{1, 2}));
+}
+
+TEST(AsyncQueue, threadPoolManyConsumers) {
+    constexpr int consumers = 10000;
+    constexpr int producers = 2;
+
+    std::vector<int> seen(consumers, 0);
+    std::atomic<int> done{0};
+    {
+        ThreadPoolExecutor executor(4);
+        AsyncQueue<int, ThreadPoolExecutor> queue(executor);
+
+        for (int i = 0; i < consumers; ++i) {
+            spawn(executor, consume(queue, seen, done));
+        }
+
+        std::vector<std::thread> threads;
+        for (int producer = 0; producer < producers; ++producer) {
+            threads.emplace_back([&, producer] {
+                for (int i = producer; i < consumers; i += producers) {
+                    queue.push(i);
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+
+        while (done.load() < consumers) {
+            std::this_thread::yield();
+        }
+    }
+
+    for (int count : seen) {
+        EXPECT_EQ(count, 1);
+    }
+}
+
+namespace {
+
+template <typename Queue>
+DetachedTask drain(Queue& queue, int count, std::vector<std::atomic<int>>& seen, std::atomic<int>& done) {
+    for (int i = 0; i < count; ++i) {
+        int value = co_await queue.pop();
+        seen[value].fetch_add(1);
+    }
+    done.fetch_add(1);
+}
+
+template <typename Queue>
+void stressWaiterList() {
+    // Few consumers that suspend over and over, so the waiter list is
+    // constantly pushed and popped while producers look at it. A lost
+    // wakeup leaves a consumer suspended with values still in the queue.
+    constexpr int consumers = 8;
+    constexpr int perConsumer = 20000;
+    constexpr int producers = 3;
+    constexpr int values = consumers * perConsumer;
+
+    std::vector<std::atomic<int>> seen(values);
+    std::atomic<int> done{0};
+    {
+        ThreadPoolExecutor executor(3);
+        Queue queue(executor);
+
+        for (int i = 0; i < consumers; ++i) {
+            spawn(executor, drain(queue, perConsumer, seen, done));
+        }
+
+        std::vector<std::thread> threads;
+        for (int producer = 0; producer < producers; ++producer) {
+            threads.emplace_back([&, producer] {
+                for (int i = producer; i < values; i += producers) {
+                    queue.push(i);
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+
+        auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+        while (done.load() < consumers && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+        ASSERT_EQ(done.load(), consumers) << "consumers still suspended: lost wakeup";
+    }
+
+    for (auto& count : seen) {
+        ASSERT_EQ(count.load(), 1);
+    }
+}
+
+}
+
+TEST(AsyncQueue, waiterListUnderContention) {
+    stressWaiterList<AsyncQueue<int, ThreadPoolExecutor>>();
+}
+
+TEST(AsyncQueue, waiterListUnderContentionTaggedQueue) {
+    stressWaiterList<AsyncQueue<int, ThreadPoolExecutor, TaggedLockFreeQueue<int>>>();
+}
+
+TEST(AsyncSPSCQueue, producerThreadConsumerCoroutine) {
+    constexpr int messages = 10000;
+    ManualExecutor executor;
+    AsyncSPSCQueue<int, 64, ManualExecutor> queue(executor);
+    std::vector<int> received;
+    std::atomic<bool> done{false};
+
+    spawn(executor, consumeAll(queue, messages, received, done));
+
+    std::thread producer([&] {
+        for (int i = 0; i < messages; ++i) {
+            while (!queue.push(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    while (!done.load()) {
+        if (!executor.runOne()) std::this_thread::yield();
+    }
+    producer.join();
+
+    ASSERT_EQ(received.size(), messages);
+    for (int i = 0; i < messages; ++i) {
+        ASSERT_EQ(received[i], i);
+    }
+}
@@ -0,0 +1,270 @@
+#include <container/journal_queue.h>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+class JournalQueueTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        directory_ = std::filesystem::temp_directory_path() /
+            ("journal_queue_test_" + std::to_string(getpid()));
+        std::filesystem::remove_all(directory_);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(directory_);
+    }
+
+    static std::span<std::byte const> bytes(std::string const& text) {
+        return {reinterpret_cast<std::byte const*>(text.data()), text.size()};
+    }
+
+    static std::string text(std::span<std::byte const> record) {
+        return {reinterpret_cast<char const*>(record.data()), record.size()};
+    }
+
+    std::filesystem::path directory_;
+};
+
+}
+
+TEST_F(JournalQueueTest, appendThenRead) {
+    JournalQueue journal(directory_);
+    JournalPosition first = journal.append(bytes("hello"));
+    journal.append(bytes(""));
+    journal.append(bytes("journal"));
+
+    EXPECT_EQ(first, (JournalPosition{0, JournalHeaderSize}));
+
+    JournalReader reader(directory_);
+    auto record = reader.next();
+    ASSERT_TRUE(record);
+    EXPECT_EQ(text(*record), "hello");
+    record = reader.next();
+    ASSERT_TRUE(record);
+    EXPECT_TRUE(record->empty());
+    record = reader.next();
+    ASSERT_TRUE(record);
+    EXPECT_EQ(text(*record), "journal");
+    EXPECT_FALSE(reader.next());
+
+    journal.append(bytes("more"));
+    record = reader.next();
+    ASSERT_TRUE(record);
+    EXPECT_EQ(text(*record), "more");
+}
+
+TEST_F(JournalQueueTest, rollsSegments) {
+    JournalOptions options;
+    options.segmentSize = 2 * JournalHeaderSize;
+    JournalQueue journal(directory_, options);
+
+    std::string const payload(1000, 'x');
+    for (int i = 0; i < 20; ++i) {
+        journal.append(bytes(std::to_string(i) + payload));
+    }
+    EXPECT_TRUE(std::filesystem::exists(journalSegmentPath(directory_, 4)));
+    EXPECT_THROW(journal.append(bytes(std::string(journal.maxRecordSize() + 1, 'x'))), std::invalid_argument);
+
+    JournalReader reader(directory_);
+    for (int i = 0; i < 20; ++i) {
+        auto record = reader.next();
+        ASSERT_TRUE(record);
+        EXPECT_EQ(text(*record), std::to_string(i) + payload);
+    }
+    EXPECT_FALSE(reader.next());
+}
+
+TEST_F(JournalQueueTest, concurrentAppendKeepsPerWriterOrder) {
+    constexpr int Writers = 4;
+    constexpr uint64_t Records = 20000;
+
+    JournalOptions options;
+    options.segmentSize = 64 << 10;
+    JournalQueue journal(directory_, options);
+
+    std::vector<std::thread> writers;
+    for (int writer = 0; writer < Writers; ++writer) {
+        writers.emplace_back([&, writer] {
+            for (uint64_t i = 0; i < Records; ++i) {
+                uint64_t const value[2] = {static_cast<uint64_t>(writer), i};
+                journal.append(std::as_bytes(std::span(value)));
+            }
+        });
+    }
+
+    // Tail the journal while it is being written.
+    JournalReader reader(directory_);
+    std::vector<uint64_t> expected(Writers, 0);
+    uint64_t read = 0;
+    while (read < Writers * Records) {
+        auto record = reader.next();
+        if (!record) {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_EQ(record->size(), 2 * sizeof(uint64_t));
+        uint64_t value[2];
+        std::memcpy(value, record->data(), sizeof(value));
+        ASSERT_LT(value[0], Writers);
+        ASSERT_EQ(value[1], expected[value[0]]++);
+        ++read;
+    }
+
+    for (auto& writer : writers) writer.join();
+    EXPECT_FALSE(reader.next());
+}
+
+TEST_F(JournalQueueTest, recoversAfterCrash) {
+    {
+        JournalQueue journal(directory_);
+        journal.append(bytes("one"));
+        journal.append(bytes("two"));
+    }
+
+    // Simulate a crash: a writer reserved a record and died while writing
+    // it, and another writer's record after it committed. The write position
+    // hint may lag behind the records, as when the crash came between a
+    // reservation and its advanceWritePosition().
+    {
+        auto segment = JournalSegment::open(directory_, 0, false);
+        ASSERT_TRUE(segment);
+        uint64_t const pending = segment->writePosition().load();
+        segment->recordWord(pending).store(packJournalRecord(5, JournalRecordState::Pending));
+        std::memcpy(segment->data() + pending + JournalRecordHeaderSize, "to", 2);
+
+        uint64_t const committed = pending + journalRecordSize(5);
+        std::memcpy(segment->data() + committed + JournalRecordHeaderSize, "four", 4);
+        segment->recordWord(committed).store(packJournalRecord(4, JournalRecordState::Committed));
+    }
+
+    JournalReader reader(directory_);
+    {
+        JournalQueue journal(directory_);
+        journal.append(bytes("five"));
+    }
+
+    std::vector<std::string> records;
+    while (auto record = reader.next()) records.push_back(text(*record));
+    EXPECT_EQ(records, (std::vector<std::string>{"one", "two", "four", "five"}));
+}
+
+TEST_F(JournalQueueTest, recoversPendingRecordInOlderSegment) {
+    JournalOptions options;
+    options.segmentSize = 2 * JournalHeaderSize;
+    std::string const payload(1500, 'r');   // two records per segment
+
+    std::vector<JournalPosition> positions;
+    {
+        JournalQueue journal(directory_, options);
+        for (int i = 0; i < 8; ++i) positions.push_back(journal.append(bytes(std::to_string(i) + payload)));
+    }
+    ASSERT_EQ(positions[7].segment, 3u);
+
+    // Simulate a crash while the writer of record 1 was still copying its
+    // payload and the others had moved on to segment 3. Segment 0 then never
+    // got finished, and every segment created since names it as the oldest
+    // unfinished one.
+    {
+        auto first = JournalSegment::open(directory_, 0, false);
+        ASSERT_TRUE(first);
+        first->recordWord(positions[1].offset).store(
+            packJournalRecord(static_cast<uint32_t>(payload.size() + 1), JournalRecordState::Pending));
+        first->finished().store(0);
+        for (uint64_t index = 1; index <= 3; ++index) {
+            JournalSegment::open(directory_, index, false)->oldestUnfinished().store(0);
+        }
+    }
+
+    {
+        JournalQueue journal(directory_, options);
+        journal.append(bytes("tail"));
+    }
+
+    JournalReader reader(directory_);
+    std::vector<std::string> records;
+    while (auto record = reader.next()) records.push_back(text(*record).substr(0, 4));
+    EXPECT_EQ(records, (std::vector<std::string>{"0rrr", "2rrr", "3rrr", "4rrr", "5rrr", "6rrr", "7rrr", "tail"}));
+}
+
+TEST_F(JournalQueueTest, unmapsFinishedSegments) {
+    auto const openFiles = [] {
+        return std::distance(std::filesystem::directory_iterator("/proc/self/fd"),
+                             std::filesystem::directory_iterator());
+    };
+
+    JournalOptions options;
+    options.segmentSize = 2 * JournalHeaderSize;
+    std::string const payload(3000, 'z');   // one record per segment
+
+    JournalQueue journal(directory_, options);
+    auto const before = openFiles();
+    JournalPosition last{};
+    for (int i = 0; i < 200; ++i) last = journal.append(bytes(payload));
+
+    ASSERT_EQ(last.segment, 199u);
+    EXPECT_LE(openFiles(), before + 1);
+
+    auto oldest = JournalSegment::open(directory_, 0, true);
+    ASSERT_TRUE(oldest);
+    EXPECT_EQ(oldest->finished().load(), 1u);
+    auto current = JournalSegment::open(directory_, last.segment, true);
+    ASSERT_TRUE(current);
+    EXPECT_EQ(current->finished().load(), 0u);
+    EXPECT_EQ(current->oldestUnfinished().load(), last.segment - 1);
+}
+
+TEST_F(JournalQueueTest, secondWriterIsRejected) {
+    {
+        JournalQueue journal(directory_);
+        journal.append(bytes("in flight"));
+
+        // Recovering now would abandon the first writer's reservations.
+        EXPECT_THROW(JournalQueue second(directory_), std::runtime_error);
+
+        // Readers do not need the lock.
+        JournalReader reader(directory_);
+        auto record = reader.next();
+        ASSERT_TRUE(record);
+        EXPECT_EQ(text(*record), "in flight");
+    }
+
+    JournalQueue reopened(directory_);
+    reopened.append(bytes("after"));
+}
+
+TEST_F(JournalQueueTest, reopenAppendsAfterLastRecord) {
+    JournalOptions options;
+    options.segmentSize = 2 * JournalHeaderSize;
+    options.syncMode = SyncMode::Async;
+    options.syncEveryRecords = 2;
+
+    std::string const payload(3000, 'y');
+    {
+        JournalQueue journal(directory_, options);
+        journal.append(bytes(payload));
+        journal.append(bytes(payload));   // rolls over to segment 1
+        journal.sync();
+    }
+    {
+        JournalQueue journal(directory_, options);
+        journal.append(bytes("tail"));
+    }
+
+    JournalReader reader(directory_);
+    int count = 0;
+    std::string last;
+    while (auto record = reader.next()) {
+        last = text(*record);
+        ++count;
+    }
+    EXPECT_EQ(count, 3);
+    EXPECT_EQ(last, "tail");
+}
@@ -0,0 +1,123 @@
+#include <container/lock_free_queue.h>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(TaggedLockFreeQueue, writeReadSequentially) {
+    constexpr int messages = 4096;
+    constexpr int turns = 4;
+
+    // Smaller than one turn, so the pool has to grow and then recycle nodes.
+    TaggedLockFreeQueue<int> queue(16);
+    for (int turn = 0; turn < turns; turn++) {
+        for (int write = 0; write < messages; write++) {
+            queue.enqueue(turn * messages + write);
+        }
+
+        for (int write = 0; write < messages; write++) {
+            int value = 0;
+            ASSERT_TRUE(queue.dequeue(value));
+            ASSERT_EQ(turn * messages + write, value);
+        }
+    }
+
+    ASSERT_TRUE(queue.empty());
+}
+
+TEST(TaggedLockFreeQueue, readEmptyQueue) {
+    TaggedLockFreeQueue<int> queue;
+
+    auto reader = std::thread([&]() {
+        int val = 0;
+        EXPECT_FALSE(queue.dequeue(val));
+        EXPECT_EQ(val, 0);
+    });
+
+    reader.join();
+
+    // No sentinel values: -1 is an ordinary element.
+    queue.enqueue(-1);
+    int value = 0;
+    ASSERT_TRUE(queue.dequeue(value));
+    EXPECT_EQ(value, -1);
+    EXPECT_FALSE(queue.dequeue(value));
+}
+
+TEST(TaggedLockFreeQueue, concurentWritersReaders) {
+    TaggedLockFreeQueue<int> queue;
+    constexpr int totalMessages = 10000;
+    constexpr int numReaders = 4;
+    constexpr int numWriters = 4;
+
+    std::atomic<int> messagesLeft = totalMessages;
+    std::atomic<int> messagesRead = 0;
+    std::vector<std::atomic<int>> result(totalMessages);
+
+    std::vector<std::thread> threads;
+    for (int reader = 0; reader < numReaders; ++reader) {
+        threads.emplace_back([&]() {
+            while (messagesRead.load() < totalMessages) {
+                int value = 0;
+                if (queue.dequeue(value)) {
+                    ASSERT_GE(value, 0);
+                    ASSERT_LT(value, totalMessages);
+                    result[value].fetch_add(1);
+                    messagesRead.fetch_add(1);
+                }
+            }
+        });
+    }
+
+    for (int writer = 0; writer < numWriters; ++writer) {
+        threads.emplace_back([&]() {
+            for (;;) {
+                int value = messagesLeft.fetch_sub(1) - 1;
+                if (value < 0) break;
+                queue.enqueue(value);
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_TRUE(queue.empty());
+    for (auto& value : result) {
+        ASSERT_EQ(value.load(), 1);
+    }
+}
+
+TEST(TaggedLockFreeQueue, neverEmptyWhileHoldingValues) {
+    // Recycling keeps the head node moving through the free list, which is
+    // what a stale empty() used to mistake for the end of the queue.
+    TaggedLockFreeQueue<int> queue(16);
+    constexpr int held = 64;
+    constexpr int churners = 3;
+    constexpr int probes = 2000000;
+
+    for (int i = 0; i < held; ++i) queue.enqueue(i);
+
+    std::atomic<bool> stop = false;
+    std::vector<std::thread> threads;
+    for (int churner = 0; churner < churners; ++churner) {
+        threads.emplace_back([&]() {
+            while (!stop.load(std::memory_order_relaxed)) {
+                int value = 0;
+                if (queue.dequeue(value)) queue.enqueue(value);
+            }
+        });
+    }
+
+    int emptyProbes = 0;
+    for (int probe = 0; probe < probes; ++probe) {
+        if (queue.empty()) ++emptyProbes;
+    }
+    stop.store(true);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(emptyProbes, 0);
+}
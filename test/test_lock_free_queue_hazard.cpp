@@ -282,4 +282,75 @@ TEST(LockFreeQueue, runOutOfHazardPointer) {
     for (auto& reader : readers) {
         reader.join();
     }
-}
\ No newline at end of file
+}
+namespace {
+
+/*!
+ * Counts live instances, to see when dequeued nodes (and the moved-from
+ * values they own) are actually freed.
+ */
+struct Tracked {
+    static inline std::atomic<int> live{0};
+
+    int value_ = 0;
+    Tracked(int value = 0) : value_(value) { live.fetch_add(1); }
+    Tracked(Tracked const& other) : value_(other.value_) { live.fetch_add(1); }
+    Tracked& operator = (Tracked const&) = default;
+    ~Tracked() { live.fetch_sub(1); }
+};
+
+using DeferredPolicy = QueuePolicy<MinimalOrdering, NoBackoff, DeferredReclamation>;
+
+}
+
+TEST(LockFreeQueue, deferredReclamationFreesOnCollect) {
+    constexpr int messages = 1000;
+    LockFreeQueue<Tracked, DeferredPolicy> queue;
+
+    for (int i = 0; i < messages; ++i) queue.enqueue(Tracked(i));
+    for (int i = 0; i < messages; ++i) {
+        Tracked value;
+        ASSERT_TRUE(queue.dequeue(value));
+        ASSERT_EQ(value.value_, i);
+    }
+
+    // Dequeue only handed the nodes off; each still owns its moved-from value.
+    EXPECT_EQ(Tracked::live.load(), messages);
+
+    DeferredRetired<Tracked>.flush();
+    EXPECT_EQ(queue.collect(), static_cast<std::size_t>(messages));
+    EXPECT_EQ(Tracked::live.load(), 0);
+    EXPECT_EQ(queue.collect(), 0u);
+}
+
+TEST(LockFreeQueue, deferredReclamationWithReclaimerThread) {
+    using Queue = LockFreeQueue<int, DeferredPolicy>;
+    constexpr int totalMessages = 100000;
+    constexpr int numReaders = 4;
+
+    ReclaimerThread<int> reclaimer(std::chrono::microseconds(10));
+    Queue queue;
+    std::atomic<int> read{0};
+    std::vector<int> result(totalMessages, 1);
+
+    std::vector<std::thread> readers;
+    for (int reader = 0; reader < numReaders; ++reader) {
+        readers.emplace_back([&]() {
+            int value;
+            while (read.load() < totalMessages) {
+                if (queue.dequeue(value)) {
+                    result[value] = 0;
+                    read.fetch_add(1);
+                }
+            }
+        });
+    }
+
+    for (int i = 0; i < totalMessages; ++i) queue.enqueue(i);
+    for (auto& reader : readers) reader.join();
+
+    ASSERT_EQ(queue.size(), 0);
+    for (auto value : result) {
+        ASSERT_EQ(value, 0);
+    }
+}
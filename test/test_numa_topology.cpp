@@ -0,0 +1,182 @@
+#include <container/lock_free_queue.h>
+#include <container/spsc_queue.h>
+#include <utils/numa.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#ifdef HAVE_LIBNUMA
+#include <numaif.h>
+#endif
+
+namespace {
+
+void writeFile(std::filesystem::path const& path, std::string const& content) {
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream(path) << content << "\n";
+}
+
+/*
+    Emulated dual-socket host: 2 nodes x 2 cores x 2 hardware threads.
+    cpu N and N + 4 are SMT siblings, each socket has its own L3.
+*/
+std::filesystem::path makeDualSocketSysfs() {
+    auto root = std::filesystem::temp_directory_path() / "numa_topology_sysfs";
+    std::filesystem::remove_all(root);
+
+    writeFile(root / "cpu/online", "0-7");
+    writeFile(root / "node/online", "0-1");
+    writeFile(root / "node/node0/cpulist", "0-1,4-5");
+    writeFile(root / "node/node1/cpulist", "2-3,6-7");
+
+    for (int cpu = 0; cpu < 8; ++cpu) {
+        int package = (cpu % 4) / 2;
+        auto base = root / ("cpu/cpu" + std::to_string(cpu));
+        writeFile(base / "topology/physical_package_id", std::to_string(package));
+        writeFile(base / "topology/core_id", std::to_string(cpu % 2));
+        writeFile(base / "cache/index3/shared_cpu_list", package ? "2-3,6-7" : "0-1,4-5");
+    }
+    return root;
+}
+
+/*
+    One socket split in two by sub-NUMA clustering, plus a memory-only node
+    with a sparse id: cpus 0-1 on node 0, cpus 2-3 on node 1, node 3 has no
+    cpus and node 2 does not exist.
+*/
+std::filesystem::path makeSubNumaSysfs() {
+    auto root = std::filesystem::temp_directory_path() / "numa_topology_snc";
+    std::filesystem::remove_all(root);
+
+    writeFile(root / "cpu/online", "0-3");
+    writeFile(root / "node/online", "0-1,3");
+    writeFile(root / "node/node0/cpulist", "0-1");
+    writeFile(root / "node/node1/cpulist", "2-3");
+    writeFile(root / "node/node3/cpulist", "");
+
+    for (int cpu = 0; cpu < 4; ++cpu) {
+        auto base = root / ("cpu/cpu" + std::to_string(cpu));
+        writeFile(base / "topology/physical_package_id", "0");
+        writeFile(base / "topology/core_id", std::to_string(cpu));
+        writeFile(base / "cache/index3/shared_cpu_list", "0-3");
+    }
+    return root;
+}
+
+}
+
+TEST(NumaTopology, parseCpuList) {
+    EXPECT_EQ(parseCpuList("0-3,8,10-11\n"), (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_EQ(parseCpuList("5"), (std::vector<int>{5}));
+    EXPECT_TRUE(parseCpuList("").empty());
+}
+
+TEST(NumaTopology, emulatedDualSocket) {
+    auto root = makeDualSocketSysfs();
+    CpuTopology topology = CpuTopology::fromSysfs(root.string());
+
+    ASSERT_EQ(topology.cpus().size(), 8);
+    EXPECT_EQ(topology.nodeCount(), 2);
+    EXPECT_EQ(topology.nodeOf(6), 1);
+
+    auto sameCore = topology.sameCorePair();
+    ASSERT_TRUE(sameCore);
+    EXPECT_EQ(*sameCore, CpuPair(0, 4));
+
+    auto sameSocket = topology.sameSocketPair();
+    ASSERT_TRUE(sameSocket);
+    EXPECT_EQ(*sameSocket, CpuPair(0, 1));
+
+    auto crossSocket = topology.crossSocketPair();
+    ASSERT_TRUE(crossSocket);
+    EXPECT_NE(topology.nodeOf(crossSocket->first), topology.nodeOf(crossSocket->second));
+    EXPECT_FALSE(topology.crossNodePair());
+
+    std::filesystem::remove_all(root);
+}
+
+TEST(NumaTopology, subNumaClusteringIsNotCrossSocket) {
+    auto root = makeSubNumaSysfs();
+    CpuTopology topology = CpuTopology::fromSysfs(root.string());
+
+    EXPECT_EQ(topology.nodes(), (std::vector<int>{0, 1, 3}));
+    EXPECT_EQ(topology.nodeCount(), 3);
+    EXPECT_EQ(topology.nodeOf(3), 1);
+
+    EXPECT_FALSE(topology.crossSocketPair());
+    auto crossNode = topology.crossNodePair();
+    ASSERT_TRUE(crossNode);
+    EXPECT_EQ(*crossNode, CpuPair(0, 2));
+
+    std::filesystem::remove_all(root);
+}
+
+TEST(NumaTopology, singleNodeFallback) {
+    auto root = std::filesystem::temp_directory_path() / "numa_topology_empty";
+    std::filesystem::remove_all(root);
+
+    CpuTopology topology = CpuTopology::fromSysfs(root.string());
+    ASSERT_EQ(topology.cpus().size(), 1);
+    EXPECT_EQ(topology.nodeCount(), 1);
+    EXPECT_FALSE(topology.sameCorePair());
+    EXPECT_FALSE(topology.crossSocketPair());
+}
+
+TEST(NumaTopology, queueOnNode) {
+    using Queue = SPSCQueue<int, 1024>;
+    int cpu = CpuTopology::instance().cpus().front().cpu;
+    Queue* queue = createOnNode<Queue>(CpuTopology::instance().nodeOf(cpu));
+
+    std::thread consumer([&] {
+        pinThisThread(cpu);
+        for (int i = 0; i < 100; ++i) {
+            int value = -1;
+            while (!queue->pop(value)) {
+                std::this_thread::yield();
+            }
+            EXPECT_EQ(value, i);
+        }
+    });
+
+    for (int i = 0; i < 100; ++i) {
+        while (!queue->push(i)) {
+            std::this_thread::yield();
+        }
+    }
+
+    consumer.join();
+    destroyOnNode(queue);
+}
+
+TEST(NumaTopology, nodeAllocatorPlacesPool) {
+    int const node = CpuTopology::instance().nodeOf(CpuTopology::instance().cpus().back().cpu);
+    NodeAllocator<int> allocator(node);
+
+    int* memory = allocator.allocate(1024);
+    memory[0] = 1;      // first touch
+#ifdef HAVE_LIBNUMA
+    if (isNumaAvailable()) {
+        void* page = memory;
+        int status = -1;
+        ASSERT_EQ(move_pages(0, 1, &page, nullptr, &status, 0), 0);
+        EXPECT_EQ(status, node);
+    }
+#endif
+    allocator.deallocate(memory, 1024);
+
+    // Several chunks, so the pool grows through the allocator while in use.
+    using Queue = TaggedLockFreeQueue<int, NodeAllocator<int>>;
+    Queue queue(Queue::ChunkSize, allocator);
+    constexpr int messages = 3 * Queue::ChunkSize;
+    for (int i = 0; i < messages; ++i) queue.enqueue(i);
+    for (int i = 0; i < messages; ++i) {
+        int value = -1;
+        ASSERT_TRUE(queue.dequeue(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_TRUE(queue.empty());
+}
@@ -0,0 +1,116 @@
+#include <utils/perf_counters.h>
+
+#include <cstdlib>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+TEST(PerfCounters, scopeCountsOrReportsWhyNot) {
+    PerfReport report;
+    constexpr uint64_t iterations = 1000000;
+    {
+        PerfScope scope(report, "loop");
+        volatile uint64_t sink = 0;
+        for (uint64_t i = 0; i < iterations; ++i) sink = sink + i;
+        scope.operations(iterations);
+    }
+
+    std::ostringstream out;
+    report.print(out, iterations);
+
+    PerfCounters counters;
+    if (!counters.available()) {
+        // No PMU access here: the benchmarks still run and say why.
+        EXPECT_NE(out.str().find("perf counters unavailable"), std::string::npos);
+        return;
+    }
+
+    auto const total = report.total(iterations);
+    auto const& instructions = total.values[static_cast<std::size_t>(PerfEvent::Instructions)];
+    if (instructions) {
+        EXPECT_GE(*instructions, iterations);
+    }
+    EXPECT_NE(out.str().find("total"), std::string::npos);
+}
+
+TEST(PerfCounters, disabledByEnvironment) {
+    setenv("PERF_COUNTERS", "0", 1);
+    PerfCounters counters;
+    unsetenv("PERF_COUNTERS");
+
+    EXPECT_FALSE(counters.available());
+    EXPECT_EQ(counters.error(), "disabled by PERF_COUNTERS=0");
+
+    PerfReport report;
+    report.unavailable(counters.error());
+    std::ostringstream out;
+    report.print(out, 1);
+    EXPECT_NE(out.str().find("disabled by PERF_COUNTERS=0"), std::string::npos);
+}
+
+TEST(PerfCounters, totalOnlyReportsEventsEveryRowHas) {
+    PerfValues first;
+    PerfValues second;
+    first[static_cast<std::size_t>(PerfEvent::Cycles)] = 100;
+    second[static_cast<std::size_t>(PerfEvent::Cycles)] = 300;
+    first[static_cast<std::size_t>(PerfEvent::RemoteHitm)] = 5;
+
+    PerfReport report;
+    report.add("a", first, 10);
+    report.add("b", second, 10);
+
+    auto const total = report.total(20);
+    EXPECT_EQ(total.values[static_cast<std::size_t>(PerfEvent::Cycles)], 400u);
+    EXPECT_FALSE(total.values[static_cast<std::size_t>(PerfEvent::RemoteHitm)]);
+    EXPECT_FALSE(total.values[static_cast<std::size_t>(PerfEvent::Instructions)]);
+}
+
+TEST(PerfCounters, unavailableThreadBlanksTheTotal) {
+    PerfValues counted;
+    counted[static_cast<std::size_t>(PerfEvent::Cycles)] = 1000;
+
+    PerfReport report;
+    report.add("counted", counted, 10);
+    report.unavailable("Too many open files");
+    report.add("unavailable", PerfValues{}, 10);
+
+    auto const total = report.total(20);
+    EXPECT_FALSE(total.values[static_cast<std::size_t>(PerfEvent::Cycles)]);
+
+    std::ostringstream out;
+    report.print(out, 20);
+    EXPECT_NE(out.str().find("partial: no counters for 1 of 2 threads"), std::string::npos) << out.str();
+}
+
+TEST(PerfCounters, scopeWithoutCountersStillAddsRow) {
+    setenv("PERF_COUNTERS", "0", 1);
+    PerfReport report;
+    {
+        PerfScope scope(report, "disabled");
+        scope.operations(5);
+    }
+    unsetenv("PERF_COUNTERS");
+
+    auto const total = report.total(5);
+    for (auto const& value : total.values) EXPECT_FALSE(value);
+
+    std::ostringstream out;
+    report.print(out, 5);
+    EXPECT_NE(out.str().find("disabled by PERF_COUNTERS=0"), std::string::npos) << out.str();
+}
+
+TEST(PerfCounters, hitmOnlyOnKnownModels) {
+    auto const config = [](std::string const& vendor, int family, int model) {
+        std::istringstream cpuinfo("processor\t: 0\nvendor_id\t: " + vendor +
+                                   "\ncpu family\t: " + std::to_string(family) +
+                                   "\nmodel\t\t: " + std::to_string(model) +
+                                   "\nmodel name\t: whatever\n\nprocessor\t: 1\nmodel\t\t: 1\n");
+        return perfHitmConfig(cpuinfo);
+    };
+
+    EXPECT_EQ(config("GenuineIntel", 6, 0x55), 0x04d3u);    // Skylake-SP
+    EXPECT_EQ(config("GenuineIntel", 6, 0x8f), 0x04d3u);    // Sapphire Rapids
+    EXPECT_FALSE(config("GenuineIntel", 6, 0x9e));          // Coffee Lake client
+    EXPECT_FALSE(config("GenuineIntel", 6, 0x3f));          // Haswell-EP, other umask
+    EXPECT_FALSE(config("AuthenticAMD", 25, 0x01));
+}
@@ -0,0 +1,198 @@
+#include <container/spsc_byte_ring.h>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+std::vector<std::byte> makePayload(std::size_t length, unsigned seed) {
+    std::vector<std::byte> payload(length);
+    for (std::size_t i = 0; i < length; ++i) {
+        payload[i] = static_cast<std::byte>((seed * 31 + i) & 0xff);
+    }
+    return payload;
+}
+
+template <typename Ring>
+void writeReadVariableLength(Ring& ring) {
+    std::minstd_rand random(7);
+
+    // Several passes over the buffer, so records regularly hit the wrap.
+    for (unsigned record = 0; record < 2000; ++record) {
+        std::size_t length = 1 + random() % (ring.maxRecordSize() / 4);
+        auto payload = makePayload(length, record);
+
+        ASSERT_TRUE(ring.push(record, payload));
+
+        auto view = ring.front();
+        ASSERT_TRUE(view);
+        EXPECT_EQ(view->type, record);
+        ASSERT_EQ(view->payload.size(), length);
+        EXPECT_TRUE(std::equal(payload.begin(), payload.end(), view->payload.begin()));
+        ring.pop();
+    }
+    EXPECT_FALSE(ring.front());
+}
+
+}
+
+TEST(SPSCByteRing, writeReadVariableLength) {
+    SPSCInlineByteRing<1024> ring;
+    writeReadVariableLength(ring);
+}
+
+TEST(SPSCByteRing, mirroredWriteReadVariableLength) {
+    SPSCMirroredByteRing ring(4096);
+    writeReadVariableLength(ring);
+}
+
+TEST(SPSCByteRing, fullAndOversized) {
+    SPSCInlineByteRing<256> ring;
+    auto payload = makePayload(56, 0);
+
+    // 8 byte header + 56 byte payload: four records fill the ring.
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(ring.push(i, payload));
+    }
+    EXPECT_FALSE(ring.push(4, payload));
+    // Full is worth a retry, oversized never is.
+    EXPECT_THROW(ring.reserve(0, ring.maxRecordSize() + 1), std::invalid_argument);
+    EXPECT_THROW(ring.push(0, makePayload(ring.maxRecordSize() + 1, 0)), std::invalid_argument);
+
+    ring.pop();
+    EXPECT_TRUE(ring.push(4, payload));
+}
+
+TEST(SPSCByteRing, reserveAndShrink) {
+    SPSCInlineByteRing<1024> ring;
+
+    auto record = ring.reserve(42, 256);
+    ASSERT_TRUE(record);
+    std::iota(reinterpret_cast<uint8_t*>(record->data()), reinterpret_cast<uint8_t*>(record->data()) + 10, 0);
+
+    // Nothing is visible before commit.
+    EXPECT_FALSE(ring.front());
+    ring.commit(10);
+
+    auto view = ring.front();
+    ASSERT_TRUE(view);
+    EXPECT_EQ(view->type, 42);
+    ASSERT_EQ(view->payload.size(), 10);
+    EXPECT_EQ(view->payload[9], std::byte{9});
+}
+
+TEST(SPSCByteRing, typedRecords) {
+    struct Quote {
+        uint64_t instrument;
+        double price;
+    };
+
+    SPSCInlineByteRing<1024> ring;
+    ASSERT_TRUE(ring.push(1, Quote{7, 101.5}));
+    ASSERT_TRUE(ring.push(2, uint32_t{99}));
+
+    auto quote = ring.front();
+    ASSERT_TRUE(quote);
+    ASSERT_EQ(quote->type, 1);
+    ASSERT_NE(quote->as<Quote>(), nullptr);
+    EXPECT_EQ(quote->as<Quote>()->instrument, 7);
+    EXPECT_EQ(quote->as<Quote>()->price, 101.5);
+    ring.pop();
+
+    auto count = ring.front();
+    ASSERT_TRUE(count);
+    ASSERT_NE(count->as<uint32_t>(), nullptr);
+    EXPECT_EQ(*count->as<uint32_t>(), 99);
+    // Too short for a Quote: no read past the payload.
+    EXPECT_EQ(count->as<Quote>(), nullptr);
+}
+
+TEST(SPSCByteRing, mirroredRecordSpansTheWrap) {
+    SPSCMirroredByteRing ring(4096);
+    auto filler = makePayload(3000, 1);
+    auto payload = makePayload(2000, 2);
+
+    ASSERT_TRUE(ring.push(0, filler));
+    ring.front();
+    ring.pop();
+
+    // Starts at offset 3008 and runs past the end: contiguous through the mirror.
+    ASSERT_TRUE(ring.push(1, payload));
+    auto view = ring.front();
+    ASSERT_TRUE(view);
+    EXPECT_TRUE(std::equal(payload.begin(), payload.end(), view->payload.begin()));
+}
+
+TEST(SPSCByteRing, concurrentProducerConsumer) {
+    SPSCInlineByteRing<4096> ring;
+    constexpr unsigned totalRecords = 20000;
+
+    std::thread producer([&] {
+        std::minstd_rand random(11);
+        for (unsigned record = 0; record < totalRecords; ++record) {
+            std::size_t length = 4 + random() % 1000;
+            std::optional<std::span<std::byte>> span;
+            while (!(span = ring.reserve(record, length))) {
+                std::this_thread::yield();
+            }
+            auto payload = makePayload(length, record);
+            std::copy(payload.begin(), payload.end(), span->begin());
+            ring.commit();
+        }
+    });
+
+    std::minstd_rand random(11);
+    for (unsigned record = 0; record < totalRecords; ++record) {
+        std::optional<RecordView> view;
+        while (!(view = ring.front())) {
+            std::this_thread::yield();
+        }
+        std::size_t length = 4 + random() % 1000;
+        auto payload = makePayload(length, record);
+        ASSERT_EQ(view->type, record);
+        ASSERT_EQ(view->payload.size(), length);
+        ASSERT_TRUE(std::equal(payload.begin(), payload.end(), view->payload.begin()));
+        ring.pop();
+    }
+
+    producer.join();
+}
+
+TEST(SPSCByteRing, paddingTypeIsNotAUserTag) {
+    SPSCInlineByteRing<256> ring;
+    auto payload = makePayload(8, 0);
+
+    EXPECT_THROW(ring.reserve(PaddingType, 8), std::invalid_argument);
+    EXPECT_THROW(ring.push(PaddingType, payload), std::invalid_argument);
+    EXPECT_FALSE(ring.front());
+}
+
+TEST(SPSCByteRing, misuseLeavesRingIntact) {
+    SPSCInlineByteRing<256> ring;
+    auto payload = makePayload(16, 3);
+
+    // pop() on an empty ring and commit() without a reservation are no-ops.
+    ring.pop();
+    ring.commit();
+    EXPECT_FALSE(ring.front());
+
+    ASSERT_TRUE(ring.push(1, payload));
+    ring.commit(16);    // already committed by push
+    EXPECT_THROW(ring.reserve(2, ring.maxRecordSize() + 1), std::invalid_argument);
+    ring.commit();      // the failed reserve() left nothing to publish
+
+    auto view = ring.front();
+    ASSERT_TRUE(view);
+    EXPECT_EQ(view->type, 1u);
+    ring.pop();
+    ring.pop();
+    EXPECT_FALSE(ring.front());
+
+    ASSERT_TRUE(ring.push(3, payload));
+    view = ring.front();
+    ASSERT_TRUE(view);
+    EXPECT_EQ(view->type, 3u);
+}
@@ -0,0 +1,121 @@
+#include <container/lock_free_queue.h>
+#include <container/lock_free_queue_hazard.h>
+#include <container/spsc_queue.h>
+
+#include "stress_harness.h"
+
+#include <gtest/gtest.h>
+
+TEST(Stress, spscQueue) {
+    SPSCQueue<uint64_t, 1024> queue;
+
+    StressReport report = runStress(makeStressConfig(1, 1),
+        [&](uint64_t value) { return queue.push(value); },
+        [&](uint64_t& value) { return queue.pop(value); });
+
+    printStressReport("SPSCQueue 1P/1C", report);
+    ASSERT_TRUE(report.ok) << report.error;
+}
+
+TEST(Stress, spscQueueSmallRing) {
+    // Capacity 4 keeps the ring permanently full/empty, stressing the index wrap.
+    SPSCQueue<uint64_t, 4> queue;
+
+    StressReport report = runStress(makeStressConfig(1, 1),
+        [&](uint64_t value) { return queue.push(value); },
+        [&](uint64_t& value) { return queue.pop(value); });
+
+    printStressReport("SPSCQueue<4> 1P/1C", report);
+    ASSERT_TRUE(report.ok) << report.error;
+}
+
+TEST(Stress, lockFreeQueueManyProducers) {
+    LockFreeQueue<uint64_t> queue;
+
+    StressReport report = runStress(makeStressConfig(4, 1),
+        [&](uint64_t value) { queue.enqueue(value); return true; },
+        [&](uint64_t& value) { return queue.dequeue(value); });
+
+    printStressReport("LockFreeQueue 4P/1C", report);
+    ASSERT_TRUE(report.ok) << report.error;
+    ASSERT_EQ(queue.size(), 0);
+}
+
+TEST(Stress, lockFreeQueueManyConsumers) {
+    LockFreeQueue<uint64_t> queue;
+
+    StressReport report = runStress(makeStressConfig(1, 4),
+        [&](uint64_t value) { queue.enqueue(value); return true; },
+        [&](uint64_t& value) { return queue.dequeue(value); });
+
+    printStressReport("LockFreeQueue 1P/4C", report);
+    ASSERT_TRUE(report.ok) << report.error;
+    ASSERT_EQ(queue.size(), 0);
+}
+
+TEST(Stress, lockFreeQueueRandomMix) {
+    LockFreeQueue<uint64_t> queue;
+
+    StressReport report = runStress(makeStressConfig(2, 2, 4),
+        [&](uint64_t value) { queue.enqueue(value); return true; },
+        [&](uint64_t& value) { return queue.dequeue(value); });
+
+    printStressReport("LockFreeQueue 2P/2C/4M", report);
+    ASSERT_TRUE(report.ok) << report.error;
+    ASSERT_EQ(queue.size(), 0);
+}
+
+TEST(Stress, lockFreeQueueBackoffPolicy) {
+    LockFreeQueue<uint64_t, QueuePolicy<MinimalOrdering, ExponentialBackoff<1, 64>>> queue;
+
+    StressReport report = runStress(makeStressConfig(2, 2, 4),
+        [&](uint64_t value) { queue.enqueue(value); return true; },
+        [&](uint64_t& value) { return queue.dequeue(value); });
+
+    printStressReport("LockFreeQueue<backoff> 2P/2C/4M", report);
+    ASSERT_TRUE(report.ok) << report.error;
+    ASSERT_EQ(queue.size(), 0);
+}
+
+TEST(Stress, lockFreeQueueDeferredReclamation) {
+    ReclaimerThread<uint64_t> reclaimer(std::chrono::microseconds(50));
+    LockFreeQueue<uint64_t, QueuePolicy<MinimalOrdering, NoBackoff, DeferredReclamation>> queue;
+
+    StressReport report = runStress(makeStressConfig(2, 2, 4),
+        [&](uint64_t value) { queue.enqueue(value); return true; },
+        [&](uint64_t& value) { return queue.dequeue(value); });
+
+    printStressReport("LockFreeQueue<deferred> 2P/2C/4M", report);
+    ASSERT_TRUE(report.ok) << report.error;
+    ASSERT_EQ(queue.size(), 0);
+}
+
+TEST(Stress, taggedLockFreeQueueRandomMix) {
+    // A single pool chunk: nodes are recycled constantly, which is where ABA bites.
+    TaggedLockFreeQueue<uint64_t> queue(1);
+
+    StressReport report = runStress(makeStressConfig(2, 2, 4),
+        [&](uint64_t value) { queue.enqueue(value); return true; },
+        [&](uint64_t& value) { return queue.dequeue(value); });
+
+    printStressReport("TaggedLockFreeQueue 2P/2C/4M", report);
+    ASSERT_TRUE(report.ok) << report.error;
+    ASSERT_TRUE(queue.empty());
+}
+
+TEST(Stress, reportsLostValuesInsteadOfHanging) {
+    // A container that silently drops every 1000th value.
+    LockFreeQueue<uint64_t> queue;
+    std::atomic<uint64_t> pushes{0};
+
+    StressReport report = runStress(makeStressConfig(2, 2),
+        [&](uint64_t value) {
+            if (pushes.fetch_add(1) % 1000 != 999) queue.enqueue(value);
+            return true;
+        },
+        [&](uint64_t& value) { return queue.dequeue(value); });
+
+    ASSERT_FALSE(report.ok);
+    EXPECT_NE(report.error.find("seen 0 times"), std::string::npos) << report.error;
+    EXPECT_NE(report.error.find("STRESS_SEED="), std::string::npos) << report.error;
+}